@@ -19,12 +19,10 @@ void* _darray_create(u64 length, u64 stride) {
     // Размер данных: ёмкость × размер элемента
     u64 array_size = length * stride;
     
-    // Выделяем память: заголовок + данные
+    // Выделяем память: заголовок + данные.
+    // kallocate уже возвращает обнулённый блок, повторно не обнуляем
     u64* new_array = kallocate(header_size + array_size, MEMORY_TAG_DARRAY);
     
-    // Обнуляем всю выделенную память
-    kset_memory(new_array, 0, header_size + array_size);
-    
     // Заполняем поля заголовка:
     new_array[DARRAY_CAPACITY] = length;  // Максимальное количество элементов
     new_array[DARRAY_LENGTH] = 0;         // Текущее количество элементов (пустой)
@@ -88,36 +86,115 @@ void _darray_field_set(void* array, u64 field, u64 value) {
 }
 
 /*
- * Увеличивает ёмкость массива в DARRAY_RESIZE_FACTOR (2) раза.
- * Копирует все существующие элементы в новый массив.
+ * Текущая политика роста (общая для всех массивов).
+ */
+static darray_growth_policy growth_policy = {DARRAY_MIN_GROW_CAPACITY, (f32)DARRAY_RESIZE_FACTOR};
+
+void darray_growth_policy_set(darray_growth_policy policy) {
+    if (policy.factor <= 1.0f) {
+        KWARN("darray_growth_policy_set - factor %f must be greater than 1, using %d.", policy.factor, DARRAY_RESIZE_FACTOR);
+        policy.factor = (f32)DARRAY_RESIZE_FACTOR;
+    }
+    if (policy.min_capacity == 0) {
+        policy.min_capacity = 1;
+    }
+    growth_policy = policy;
+}
+
+darray_growth_policy darray_growth_policy_get() {
+    return growth_policy;
+}
+
+/*
+ * Меняет ёмкость массива на new_capacity (не меньше length).
+ * 
+ * Когда массив заполнен (length == capacity), блок расширяется через
+ * kreallocate: обычно на месте или переотображением страниц, а если
+ * всё же с копированием - то копируются только живые элементы.
+ * Если же массив заполнен частично, realloc скопировал бы и мёртвый хвост,
+ * поэтому выделяем новый блок и переносим только length * stride байт.
+ */
+static void* darray_set_capacity(void* array, u64 new_capacity) {
+    u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+    u64* header = (u64*)array - DARRAY_FIELD_LENGTH;
+    u64 capacity = header[DARRAY_CAPACITY];
+    u64 length = header[DARRAY_LENGTH];
+    u64 stride = header[DARRAY_STRIDE];
+    u64 old_size = header_size + capacity * stride;
+    u64 new_size = header_size + new_capacity * stride;
+
+    if (length == capacity || new_capacity <= length) {
+        u64* new_header = kreallocate(header, old_size, new_size, MEMORY_TAG_DARRAY);
+        if (!new_header) {
+            KERROR("darray - failed to resize array to %llu elements.", new_capacity);
+            return array;
+        }
+        new_header[DARRAY_CAPACITY] = new_capacity;
+        return (void*)(new_header + DARRAY_FIELD_LENGTH);
+    }
+
+    u64* new_header = kallocate_ex(new_size, 0, MEMORY_TAG_DARRAY, KALLOCATE_FLAG_NO_ZERO);
+    new_header[DARRAY_CAPACITY] = new_capacity;
+    new_header[DARRAY_LENGTH] = length;
+    new_header[DARRAY_STRIDE] = stride;
+    void* temp = (void*)(new_header + DARRAY_FIELD_LENGTH);
+    kcopy_memory(temp, array, length * stride);
+    kfree(header, old_size, MEMORY_TAG_DARRAY);
+    return temp;
+}
+
+/*
+ * Следующая ёмкость по политике роста, но не меньше required.
+ */
+static u64 darray_next_capacity(u64 capacity, u64 required) {
+    u64 next = (u64)((f64)capacity * growth_policy.factor);
+    if (next <= capacity) {
+        next = capacity + 1;
+    }
+    if (next < growth_policy.min_capacity) {
+        next = growth_policy.min_capacity;
+    }
+    if (next < required) {
+        next = required;
+    }
+    return next;
+}
+
+/*
+ * Увеличивает ёмкость массива по текущей политике роста
+ * (по умолчанию в DARRAY_RESIZE_FACTOR (2) раза).
  * 
  * Параметры:
  *   array - указатель на текущий массив
  * 
  * Возвращает:
- *   Указатель на новый массив со увеличенной ёмкостью
+ *   Указатель на массив с увеличенной ёмкостью (может измениться)
  */
 void* _darray_resize(void* array) {
-    // Получаем текущие параметры массива
+    u64 capacity = darray_capacity(array);
+    return darray_set_capacity(array, darray_next_capacity(capacity, capacity + 1));
+}
+
+/*
+ * Гарантирует ёмкость не меньше capacity.
+ */
+void* _darray_ensure_capacity(void* array, u64 capacity) {
+    if (capacity <= darray_capacity(array)) {
+        return array;
+    }
+    return darray_set_capacity(array, capacity);
+}
+
+/*
+ * Сжимает ёмкость до длины массива.
+ */
+void* _darray_shrink_to_fit(void* array) {
     u64 length = darray_length(array);
-    u64 stride = darray_stride(array);
-    
-    // Создаём новый массив с увеличенной ёмкостью (в 2 раза)
-    void* temp = _darray_create(
-        (DARRAY_RESIZE_FACTOR * darray_capacity(array)),  // Новая ёмкость
-        stride);                                           // Размер элемента
-    
-    // Копируем все существующие элементы из старого массива
-    kcopy_memory(temp, array, length * stride);
-    
-    // Восстанавливаем длину в новом массиве
-    _darray_field_set(temp, DARRAY_LENGTH, length);
-    
-    // Уничтожаем старый массив
-    _darray_destroy(array);
-    
-    // Возвращаем новый массив
-    return temp;
+    u64 target = length > 0 ? length : 1;
+    if (target >= darray_capacity(array)) {
+        return array;
+    }
+    return darray_set_capacity(array, target);
 }
 
 /*
@@ -196,35 +273,7 @@ void _darray_pop(void* array, void* dest) {
  *   Указатель на массив
  */
 void* _darray_pop_at(void* array, u64 index, void* dest) {
-    u64 length = darray_length(array);
-    u64 stride = darray_stride(array);
-    
-    // Проверка выхода за границы
-    if (index >= length) {
-        KERROR("Index outside the bounds of this array! Length: %i, index: %index", length, index);
-        return array;
-    }
-    
-    u64 addr = (u64)array;
-    
-    // Если нужно, сохраняем удаляемый элемент
-    if (dest) {
-        kcopy_memory(dest, (void*)(addr + (index * stride)), stride);
-    }
-    
-    // Если удаляем не последний элемент, нужно сдвинуть остальные
-    if (index != length - 1) {
-        // Копируем блок элементов [index+1 .. length-1] в [index .. length-2]
-        kcopy_memory(
-            (void*)(addr + (index * stride)),            // Куда: позиция удаляемого элемента
-            (void*)(addr + ((index + 1) * stride)),      // Откуда: следующий элемент
-            stride * (length - index));                  // Сколько: все элементы после удаляемого
-    }
-    
-    // Уменьшаем счётчик элементов
-    _darray_field_set(array, DARRAY_LENGTH, length - 1);
-    
-    return array;
+    return _darray_remove_range(array, index, 1, dest);
 }
 
 /*
@@ -242,37 +291,153 @@ void* _darray_pop_at(void* array, u64 index, void* dest) {
  */
 void* _darray_insert_at(void* array, u64 index, void* value_ptr) {
     u64 length = darray_length(array);
-    u64 stride = darray_stride(array);
     
     // Проверка выхода за границы
     if (index >= length) {
-        KERROR("Index outside the bounds of this array! Length: %i, index: %index", length, index);
+        KERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
         return array;
     }
     
-    // Проверяем, нужно ли увеличивать ёмкость
-    if (length >= darray_capacity(array)) {
-        array = _darray_resize(array);
+    return _darray_insert_range(array, index, value_ptr, 1);
+}
+
+/*
+ * Лежит ли источник копирования внутри элементов самого массива
+ * (например, darray_append(a, a)). После роста такой указатель
+ * указывал бы в освобождённый блок.
+ */
+static b8 darray_is_own_memory(void* array, const void* values) {
+    const u8* begin = (const u8*)array;
+    const u8* end = begin + darray_capacity(array) * darray_stride(array);
+    return (const u8*)values >= begin && (const u8*)values < end;
+}
+
+/*
+ * Добавляет count элементов в конец массива.
+ * Одна проверка ёмкости и одно копирование на весь блок.
+ * values может указывать в сам массив.
+ */
+void* _darray_push_n(void* array, const void* values, u64 count) {
+    if (count == 0) {
+        return array;
     }
+    u64 length = darray_length(array);
+    u64 stride = darray_stride(array);
     
-    u64 addr = (u64)array;
+    if (length + count > darray_capacity(array)) {
+        // Источник внутри массива переезжает вместе с ним - пересчитываем
+        // указатель от нового начала
+        b8 own = darray_is_own_memory(array, values);
+        u64 offset = (u64)((const u8*)values - (const u8*)array);
+        array = darray_set_capacity(array, darray_next_capacity(darray_capacity(array), length + count));
+        if (own) {
+            values = (const u8*)array + offset;
+        }
+    }
     
-    // Если вставляем не в конец, нужно сдвинуть существующие элементы
-    if (index != length - 1) {
-        // Копируем блок элементов [index .. length-1] в [index+1 .. length]
-        kcopy_memory(
-            (void*)(addr + ((index + 1) * stride)),      // Куда: на позицию после вставки
-            (void*)(addr + (index * stride)),            // Откуда: позиция вставки
-            stride * (length - index));                  // Сколько: все элементы начиная с index
+    kcopy_memory((u8*)array + length * stride, values, count * stride);
+    _darray_field_set(array, DARRAY_LENGTH, length + count);
+    return array;
+}
+
+/*
+ * Дописывает в конец массива все элементы другого массива того же типа.
+ */
+void* _darray_append(void* array, const void* source) {
+    if (darray_stride(array) != darray_stride((void*)source)) {
+        KERROR("darray_append - stride mismatch: %llu vs %llu.", darray_stride(array), darray_stride((void*)source));
+        return array;
     }
+    return _darray_push_n(array, source, darray_length((void*)source));
+}
+
+/*
+ * Вставляет count элементов начиная с индекса index (0..length).
+ * Хвост сдвигается один раз на count позиций.
+ * values может указывать в сам массив.
+ */
+void* _darray_insert_range(void* array, u64 index, const void* values, u64 count) {
+    u64 length = darray_length(array);
+    u64 stride = darray_stride(array);
     
-    // Записываем новый элемент на освободившееся место
-    kcopy_memory((void*)(addr + (index * stride)), value_ptr, stride);
+    // Проверка выхода за границы (index == length - вставка в конец)
+    if (index > length) {
+        KERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
+        return array;
+    }
+    if (count == 0) {
+        return array;
+    }
     
-    // Увеличиваем счётчик элементов
-    _darray_field_set(array, DARRAY_LENGTH, length + 1);
+    // Источник внутри массива сдвинется (или переедет) вместе с хвостом:
+    // вставляем из временной копии
+    if (darray_is_own_memory(array, values)) {
+        void* copy = kallocate_ex(count * stride, 0, MEMORY_TAG_DARRAY, KALLOCATE_FLAG_NO_ZERO);
+        kcopy_memory(copy, values, count * stride);
+        array = _darray_insert_range(array, index, copy, count);
+        kfree(copy, count * stride, MEMORY_TAG_DARRAY);
+        return array;
+    }
     
+    if (length + count > darray_capacity(array)) {
+        array = darray_set_capacity(array, darray_next_capacity(darray_capacity(array), length + count));
+    }
+    
+    u8* addr = (u8*)array;
+    // Области пересекаются - нужен memmove, а не memcpy
+    kmove_memory(addr + (index + count) * stride, addr + index * stride, (length - index) * stride);
+    kcopy_memory(addr + index * stride, values, count * stride);
+    _darray_field_set(array, DARRAY_LENGTH, length + count);
     return array;
 }
 
+/*
+ * Удаляет count элементов начиная с индекса index.
+ * Хвост сдвигается один раз на count позиций влево.
+ */
+void* _darray_remove_range(void* array, u64 index, u64 count, void* dest) {
+    u64 length = darray_length(array);
+    u64 stride = darray_stride(array);
+    
+    // Проверка выхода за границы
+    if (index >= length || count > length - index) {
+        KERROR("Range outside the bounds of this array! Length: %llu, index: %llu, count: %llu", length, index, count);
+        return array;
+    }
+    
+    u8* addr = (u8*)array;
+    
+    // Если нужно, сохраняем удаляемые элементы
+    if (dest) {
+        kcopy_memory(dest, addr + index * stride, count * stride);
+    }
+    
+    // Сдвигаем элементы [index+count .. length-1] на место удалённых
+    kmove_memory(addr + index * stride, addr + (index + count) * stride, (length - index - count) * stride);
+    _darray_field_set(array, DARRAY_LENGTH, length - count);
+    return array;
+}
 
+/*
+ * Удаляет элемент за O(1): на его место переносится последний элемент.
+ * Порядок элементов не сохраняется.
+ */
+void _darray_swap_remove(void* array, u64 index, void* dest) {
+    u64 length = darray_length(array);
+    u64 stride = darray_stride(array);
+    
+    // Проверка выхода за границы
+    if (index >= length) {
+        KERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
+        return;
+    }
+    
+    u8* addr = (u8*)array;
+    if (dest) {
+        kcopy_memory(dest, addr + index * stride, stride);
+    }
+    if (index != length - 1) {
+        kcopy_memory(addr + index * stride, addr + (length - 1) * stride, stride);
+    }
+    _darray_field_set(array, DARRAY_LENGTH, length - 1);
+}
@@ -33,6 +33,26 @@ enum {
     DARRAY_FIELD_LENGTH // количество полей (используется для проверок)
 };
 
+/*
+ * Заголовок массива в виде структуры - та же раскладка, что и у полей выше.
+ * Через него длина/ёмкость/stride читаются обычной загрузкой из памяти,
+ * без вызова экспортируемой _darray_field_get через границу библиотеки.
+ */
+typedef struct darray_header {
+    u64 capacity;  // DARRAY_CAPACITY
+    u64 length;    // DARRAY_LENGTH
+    u64 stride;    // DARRAY_STRIDE
+} darray_header;
+
+STATIC_ASSERT(sizeof(darray_header) == DARRAY_FIELD_LENGTH * sizeof(u64), "darray_header must match the field layout.");
+
+/*
+ * Возвращает заголовок массива (лежит прямо перед первым элементом).
+ */
+static inline darray_header* darray_header_get(const void* array) {
+    return (darray_header*)array - 1;
+}
+
 /*
  * Создаёт новый динамический массив.
  * Выделяет память для метаданных и элементов.
@@ -78,6 +98,80 @@ KAPI u64 _darray_field_get(void* array, u64 field);
  */
 KAPI void _darray_field_set(void* array, u64 field, u64 value);
 
+/*
+ * Добавляет count элементов в конец массива за одну проверку ёмкости
+ * и одно копирование.
+ * 
+ * Параметры:
+ *   array  - указатель на массив
+ *   values - указатель на count подряд идущих элементов
+ *            (может указывать в сам массив)
+ *   count  - количество элементов
+ * 
+ * Возвращает:
+ *   Новый указатель на массив (может измениться)
+ */
+KAPI void* _darray_push_n(void* array, const void* values, u64 count);
+
+/*
+ * Дописывает в конец массива все элементы массива source
+ * (stride массивов должен совпадать). source может быть самим array.
+ * 
+ * Возвращает:
+ *   Новый указатель на массив (может измениться)
+ */
+KAPI void* _darray_append(void* array, const void* source);
+
+/*
+ * Вставляет count элементов начиная с индекса index (0..length).
+ * values может указывать в сам массив.
+ * 
+ * Возвращает:
+ *   Новый указатель на массив (может измениться)
+ */
+KAPI void* _darray_insert_range(void* array, u64 index, const void* values, u64 count);
+
+/*
+ * Удаляет count элементов начиная с индекса index, сохраняя порядок.
+ * 
+ * Параметры:
+ *   dest - куда скопировать удаляемые элементы (может быть NULL)
+ * 
+ * Возвращает:
+ *   Указатель на массив
+ */
+KAPI void* _darray_remove_range(void* array, u64 index, u64 count, void* dest);
+
+/*
+ * Удаляет элемент за O(1), перенося на его место последний элемент.
+ * Порядок элементов НЕ сохраняется.
+ * 
+ * Параметры:
+ *   dest - куда скопировать удаляемый элемент (может быть NULL)
+ */
+KAPI void _darray_swap_remove(void* array, u64 index, void* dest);
+
+/*
+ * Политика роста массивов.
+ * Новая ёмкость при нехватке места:
+ *   max(min_capacity, capacity * factor, требуемая ёмкость)
+ */
+typedef struct darray_growth_policy {
+    u64 min_capacity;  // минимальная ёмкость после первого роста
+    f32 factor;        // во сколько раз растёт ёмкость (> 1)
+} darray_growth_policy;
+
+/*
+ * Устанавливает политику роста для всех массивов.
+ * Ранее созданные массивы подхватывают её при следующем росте.
+ */
+KAPI void darray_growth_policy_set(darray_growth_policy policy);
+
+/*
+ * Возвращает текущую политику роста.
+ */
+KAPI darray_growth_policy darray_growth_policy_get();
+
 /*
  * Изменяет размер массива (увеличивает ёмкость).
  * Используется внутренне, когда нужно больше места.
@@ -90,6 +184,25 @@ KAPI void _darray_field_set(void* array, u64 field, u64 value);
  */
 KAPI void* _darray_resize(void* array);
 
+/*
+ * Гарантирует ёмкость не меньше capacity.
+ * Если места уже хватает - ничего не делает.
+ * Копируется не больше length * stride байт.
+ * 
+ * Возвращает:
+ *   Новый указатель на массив (может измениться)
+ */
+KAPI void* _darray_ensure_capacity(void* array, u64 capacity);
+
+/*
+ * Уменьшает ёмкость до текущей длины (но не меньше 1 элемента).
+ * Копируется не больше length * stride байт.
+ * 
+ * Возвращает:
+ *   Новый указатель на массив (может измениться)
+ */
+KAPI void* _darray_shrink_to_fit(void* array);
+
 /*
  * Добавляет элемент в конец массива.
  * 
@@ -141,7 +254,13 @@ KAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * Константы конфигурации:
  */
 #define DARRAY_DEFAULT_CAPACITY 1   // Начальная ёмкость по умолчанию
-#define DARRAY_RESIZE_FACTOR 2      // Коэффициент увеличения при перераспределении
+#define DARRAY_RESIZE_FACTOR 2      // Коэффициент увеличения по умолчанию (darray_growth_policy.factor)
+#define DARRAY_MIN_GROW_CAPACITY 8  // Ёмкость после первого роста по умолчанию (darray_growth_policy.min_capacity)
+
+/*
+ * Примечание: после роста ёмкости элементы за пределами length
+ * не обнуляются (обнулена только память свежесозданного массива).
+ */
 
 /*
  * Макросы для удобного использования с типами:
@@ -170,6 +289,15 @@ KAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
  * typeof() работает хорошо, хотя оба являются расширениями GNU.
  */
 
+// Гарантирует ёмкость не меньше capacity (в отличие от darray_reserve,
+// который создаёт новый массив)
+#define darray_ensure_capacity(array, capacity) \
+    array = _darray_ensure_capacity(array, capacity)
+
+// Освобождает неиспользуемую ёмкость
+#define darray_shrink_to_fit(array) \
+    array = _darray_shrink_to_fit(array)
+
 // Удаляет элемент с конца массива
 #define darray_pop(array, value_ptr) \
     _darray_pop(array, value_ptr)
@@ -185,22 +313,75 @@ KAPI void* _darray_insert_at(void* array, u64 index, void* value_ptr);
 #define darray_pop_at(array, index, value_ptr) \
     _darray_pop_at(array, index, value_ptr)
 
+// Добавляет count элементов из values_ptr в конец массива
+#define darray_push_n(array, values_ptr, count) \
+    array = _darray_push_n(array, values_ptr, count)
+
+// Дописывает в конец массива все элементы массива source
+#define darray_append(array, source) \
+    array = _darray_append(array, source)
+
+// Вставляет count элементов из values_ptr по индексу index
+#define darray_insert_range(array, index, values_ptr, count) \
+    array = _darray_insert_range(array, index, values_ptr, count)
+
+// Удаляет count элементов начиная с index (порядок сохраняется)
+#define darray_remove_range(array, index, count, dest_ptr) \
+    _darray_remove_range(array, index, count, dest_ptr)
+
+// Удаляет элемент за O(1) без сохранения порядка
+#define darray_swap_remove(array, index, value_ptr) \
+    _darray_swap_remove(array, index, value_ptr)
+
 // Очищает массив (устанавливает length = 0, но не освобождает память)
 #define darray_clear(array) \
-    _darray_field_set(array, DARRAY_LENGTH, 0)
+    (darray_header_get(array)->length = 0)
 
 // Получает текущую ёмкость массива
 #define darray_capacity(array) \
-    _darray_field_get(array, DARRAY_CAPACITY)
+    (darray_header_get(array)->capacity)
 
 // Получает текущее количество элементов
 #define darray_length(array) \
-    _darray_field_get(array, DARRAY_LENGTH)
+    (darray_header_get(array)->length)
 
 // Получает размер элемента в байтах
 #define darray_stride(array) \
-    _darray_field_get(array, DARRAY_STRIDE)
+    (darray_header_get(array)->stride)
 
 // Устанавливает количество элементов (осторожно!)
 #define darray_length_set(array, value) \
-    _darray_field_set(array, DARRAY_LENGTH, value)
\ No newline at end of file
+    (darray_header_get(array)->length = (value))
+
+/*
+ * Типизированные версии: размер элемента берётся из sizeof(type)
+ * на этапе компиляции, а не из stride в заголовке.
+ * Если место есть, запись/чтение идут напрямую, без вызова функций.
+ */
+
+// Добавляет элемент типа type в конец массива
+#define darray_push_typed(array, type, value)                                 \
+    {                                                                         \
+        darray_header* _header = darray_header_get(array);                    \
+        if (_header->length < _header->capacity) {                            \
+            ((type*)(array))[_header->length++] = (value);                    \
+        } else {                                                              \
+            type _temp = (value);                                             \
+            array = _darray_push(array, &_temp);                              \
+        }                                                                     \
+    }
+
+// Удаляет последний элемент типа type, копируя его в *value_ptr (если не NULL)
+#define darray_pop_typed(array, type, value_ptr)                              \
+    {                                                                         \
+        darray_header* _header = darray_header_get(array);                    \
+        type* _dest = (value_ptr);                                            \
+        --_header->length;                                                    \
+        if (_dest) {                                                          \
+            *_dest = ((type*)(array))[_header->length];                       \
+        }                                                                     \
+    }
+
+// Размер занятой части массива в байтах для элементов типа type
+#define darray_size_typed(array, type) \
+    (darray_length(array) * sizeof(type))
@@ -0,0 +1,85 @@
+#include "containers/mpsc_queue.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+
+//номер последовательности ячейки (первые 8 байт)
+static inline atomic_u64* mpsc_cell_sequence(mpsc_queue* queue, u64 position) {
+    return (atomic_u64*)(queue->cells + (position & queue->mask) * queue->cell_size);
+}
+
+b8 mpsc_queue_create(u64 capacity, u64 stride, mpsc_queue* out_queue) {
+    if (!out_queue || capacity < 2 || stride == 0) {
+        KERROR("mpsc_queue_create - invalid parameters (capacity %llu, stride %llu).", capacity, stride);
+        return FALSE;
+    }
+    // Округляем ёмкость до степени двойки, чтобы позиция бралась маской
+    u64 rounded = 2;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    kzero_memory(out_queue, sizeof(mpsc_queue));
+    out_queue->capacity = rounded;
+    out_queue->mask = rounded - 1;
+    out_queue->stride = stride;
+    out_queue->cell_size = sizeof(u64) + ((stride + 7) & ~(u64)7);
+    out_queue->cells = kallocate_ex(out_queue->cell_size * rounded, PLATFORM_CACHE_LINE_SIZE, MEMORY_TAG_RING_QUEUE, KALLOCATE_FLAG_NO_ZERO);
+
+    // Ячейка i свободна для позиции i
+    for (u64 i = 0; i < rounded; ++i) {
+        atomic_store_u64(mpsc_cell_sequence(out_queue, i), i, ATOMIC_ORDER_RELAXED);
+    }
+    return TRUE;
+}
+
+void mpsc_queue_destroy(mpsc_queue* queue) {
+    if (!queue || !queue->cells) {
+        return;
+    }
+    kfree_ex(queue->cells, queue->cell_size * queue->capacity, PLATFORM_CACHE_LINE_SIZE, MEMORY_TAG_RING_QUEUE);
+    kzero_memory(queue, sizeof(mpsc_queue));
+}
+
+b8 mpsc_queue_push(mpsc_queue* queue, const void* value) {
+    u64 position = atomic_load_u64(&queue->tail, ATOMIC_ORDER_RELAXED);
+    for (;;) {
+        atomic_u64* sequence = mpsc_cell_sequence(queue, position);
+        i64 diff = (i64)(atomic_load_u64(sequence, ATOMIC_ORDER_ACQUIRE) - position);
+        if (diff == 0) {
+            // Ячейка свободна - пытаемся занять позицию
+            if (atomic_compare_exchange_u64(&queue->tail, &position, position + 1,
+                                            ATOMIC_ORDER_RELAXED, ATOMIC_ORDER_RELAXED)) {
+                kcopy_memory(sequence + 1, value, queue->stride);
+                // Публикуем данные для потребителя
+                atomic_store_u64(sequence, position + 1, ATOMIC_ORDER_RELEASE);
+                return TRUE;
+            }
+            // CAS не удался - position уже обновлена актуальным tail
+        } else if (diff < 0) {
+            // Потребитель ещё не освободил ячейку круг назад - очередь полна
+            return FALSE;
+        } else {
+            // Другой производитель успел раньше
+            position = atomic_load_u64(&queue->tail, ATOMIC_ORDER_RELAXED);
+        }
+    }
+}
+
+b8 mpsc_queue_pop(mpsc_queue* queue, void* out_value) {
+    u64 position = queue->head;
+    atomic_u64* sequence = mpsc_cell_sequence(queue, position);
+    if (atomic_load_u64(sequence, ATOMIC_ORDER_ACQUIRE) != position + 1) {
+        // Ячейка ещё не опубликована (пусто или производитель в процессе записи)
+        return FALSE;
+    }
+    kcopy_memory(out_value, sequence + 1, queue->stride);
+    // Освобождаем ячейку для позиции на круг вперёд
+    atomic_store_u64(sequence, position + queue->capacity, ATOMIC_ORDER_RELEASE);
+    queue->head = position + 1;
+    return TRUE;
+}
+
+u64 mpsc_queue_enqueued_count(mpsc_queue* queue) {
+    return atomic_load_u64(&queue->tail, ATOMIC_ORDER_ACQUIRE);
+}
@@ -0,0 +1,77 @@
+/*
+  Ограниченная lock-free очередь: много производителей, один потребитель
+  (MPSC - multi-producer, single-consumer).
+
+  Любой поток может положить элемент без блокировок; забирает элементы
+  только один поток. Элементы фиксированного размера копируются в
+  заранее выделенный кольцевой буфер.
+
+  Каждая ячейка хранит порядковый номер (sequence). Производитель занимает
+  позицию через CAS по tail и публикует данные, записывая sequence = pos + 1.
+  Потребитель видит ячейку готовой, когда sequence == head + 1.
+  Порядок выдачи - порядок, в котором производители заняли позиции;
+  элементы одного производителя выходят в порядке постановки.
+*/
+#pragma once
+
+#include "defines.h"
+#include "platform/atomic.h"
+#include "platform/platform.h"
+
+typedef struct mpsc_queue {
+    u8* cells;          // capacity ячеек по cell_size байт
+    u64 capacity;       // степень двойки
+    u64 mask;           // capacity - 1
+    u64 stride;         // размер элемента
+    u64 cell_size;      // sequence + элемент, кратно 8
+    // head и tail - в разных кэш-линиях: производители и потребитель
+    // не делят одну линию
+    u8 _pad0[PLATFORM_CACHE_LINE_SIZE];
+    atomic_u64 tail;    // следующая позиция для производителей (CAS)
+    u8 _pad1[PLATFORM_CACHE_LINE_SIZE - sizeof(atomic_u64)];
+    u64 head;           // следующая позиция потребителя (пишет только он)
+    u8 _pad2[PLATFORM_CACHE_LINE_SIZE - sizeof(u64)];
+} mpsc_queue;
+
+/*
+ * Создаёт очередь.
+ * 
+ * Параметры:
+ *   capacity  - ёмкость в элементах (округляется вверх до степени двойки)
+ *   stride    - размер одного элемента в байтах
+ *   out_queue - куда записать состояние очереди
+ * 
+ * Возвращает:
+ *   TRUE при успехе
+ */
+KAPI b8 mpsc_queue_create(u64 capacity, u64 stride, mpsc_queue* out_queue);
+
+/*
+ * Уничтожает очередь. Вызывать, когда производителей уже нет.
+ */
+KAPI void mpsc_queue_destroy(mpsc_queue* queue);
+
+/*
+ * Кладёт элемент в очередь. Можно вызывать из любого потока.
+ * 
+ * Возвращает:
+ *   TRUE - элемент поставлен, FALSE - очередь заполнена
+ */
+KAPI b8 mpsc_queue_push(mpsc_queue* queue, const void* value);
+
+/*
+ * Забирает элемент из очереди. Только поток-потребитель.
+ * 
+ * Возвращает:
+ *   TRUE - элемент скопирован в out_value, FALSE - готовых элементов нет
+ */
+KAPI b8 mpsc_queue_pop(mpsc_queue* queue, void* out_value);
+
+/*
+ * Сколько позиций заняли производители с создания очереди (растёт
+ * монотонно). Считаются занятые позиции, а не опубликованные элементы:
+ * производитель мог занять позицию и ещё не дописать элемент. Потребитель,
+ * выдавший столько элементов, получил всё, что было занято к моменту вызова.
+ * Можно вызывать из любого потока.
+ */
+KAPI u64 mpsc_queue_enqueued_count(mpsc_queue* queue);
@@ -12,6 +12,21 @@
 #include "core/kmemory.h" 
 #include "core/event.h"
 #include "core/input.h" 
+#include "core/clock.h"
+#include "core/frame_stats.h"
+#include "core/profiler.h"
+#include "core/job_system.h"
+
+#include "memory/linear_allocator.h"
+
+//размер кадровой арены (4 МиБ)
+#define APPLICATION_FRAME_ALLOCATOR_SIZE (4 * 1024 * 1024)
+
+//шаг симуляции (и кадра записи/воспроизведения ввода) по умолчанию
+#define APPLICATION_DEFAULT_FIXED_TIMESTEP (1.0 / 60.0)
+
+//сколько шагов симуляции можно догнать за один кадр по умолчанию
+#define APPLICATION_DEFAULT_MAX_CATCH_UP_STEPS 5
 
 //хранит глобальное состояние приложения
 //управляет игровым циклом
@@ -31,8 +46,32 @@ typedef struct application_state {
  i16 width; // Ширина
  i16 height; // Высота
 
- // Временная метка для расчёта дельты времени
+ // Часы движка и время прошлого кадра по ним (для дельты)
+ clock clock;
  f64 last_time;
+
+ // Фиксированный шаг симуляции: накопленное, но ещё не просимулированное время
+ b8 fixed_update;
+ f64 accumulator;
+ u32 max_catch_up_steps;
+ u64 dropped_steps;  // шагов отброшено из-за отставания
+
+ // Темп кадров: длительность кадра, 0 - без ограничения
+ f64 target_frame_time;
+
+ // Сводка хронометража кадров в лог: период в секундах (0 - нет) и
+ // время по часам движка, когда она выводилась в последний раз
+ f64 frame_stats_log_interval;
+ f64 last_frame_stats_log;
+
+ // Кадровая арена: сбрасывается в начале каждого кадра
+ linear_allocator frame_allocator;
+
+ // Запись/воспроизведение ввода: кадры идут с фиксированным шагом
+ b8 recording;
+ b8 replaying;
+ b8 unthrottled;      // воспроизведение без ожидания реального времени
+ f64 fixed_timestep;
 } application_state;
 
 //static - имеют внутреннее связывание(видны только в этом файле/еденице трансляции)
@@ -56,8 +95,25 @@ b8 application_create(game* game_inst) {
 
  //Инициализация системы логирования и ввода 
  initialize_logging();
+ if (game_inst->app_config.log_file_path) {
+  log_file_config file_config;
+  file_config.path = game_inst->app_config.log_file_path;
+  file_config.max_size = game_inst->app_config.log_file_max_size;
+  file_config.max_files = game_inst->app_config.log_file_max_files;
+  file_config.per_level_files = game_inst->app_config.log_file_per_level;
+  logger_file_begin(&file_config);
+ }
+ if (game_inst->app_config.binary_log_path) {
+  logger_binary_begin(game_inst->app_config.binary_log_path);
+ }
  input_initialize();
 
+ //профилирование зон с записью трассы при завершении
+ profiler_set_thread_name("main");
+ if (game_inst->app_config.profile_trace_path) {
+  profiler_start();
+ }
+
  // TODO: Remove this
  KFATAL("A test message: %f", 3.14f);
  KERROR("A test message: %f", 3.14f);
@@ -76,6 +132,16 @@ b8 application_create(game* game_inst) {
         return FALSE;
     }
 
+ //рабочие потоки системы задач
+ if (!job_system_initialize(game_inst->app_config.job_worker_count)) {
+  KERROR("Job system failed initialization. Application cannot continue.");
+  return FALSE;
+ }
+
+ //Кадровая арена для временных данных кадра
+ void* frame_memory = kallocate_ex(APPLICATION_FRAME_ALLOCATOR_SIZE, 0, MEMORY_TAG_FRAME, KALLOCATE_FLAG_NO_ZERO);
+ linear_allocator_create(APPLICATION_FRAME_ALLOCATOR_SIZE, frame_memory, &app_state.frame_allocator);
+
  //Инициализация платформы, через game_inst
  if (!platform_startup(
   &app_state.platform,
@@ -104,6 +170,36 @@ b8 application_create(game* game_inst) {
  //вызов обработчика изменения размера
  app_state.game_inst->on_resize(app_state.game_inst, app_state.width, app_state.height);
 
+ //запись или воспроизведение ввода
+ application_config* config = &game_inst->app_config;
+ app_state.fixed_timestep = config->fixed_timestep > 0 ? config->fixed_timestep : APPLICATION_DEFAULT_FIXED_TIMESTEP;
+ app_state.fixed_update = config->fixed_update;
+ app_state.max_catch_up_steps = config->max_catch_up_steps ? config->max_catch_up_steps : APPLICATION_DEFAULT_MAX_CATCH_UP_STEPS;
+ app_state.frame_stats_log_interval = config->frame_stats_log_interval;
+ if (config->input_replay_path) {
+  // шаг кадра берётся из записи, иначе прогон не повторит сессию
+  if (!input_playback_begin(config->input_replay_path, &app_state.fixed_timestep)) {
+   KFATAL("Failed to start input replay from '%s'.", config->input_replay_path);
+   return FALSE;
+  }
+  app_state.replaying = TRUE;
+  app_state.unthrottled = config->replay_unthrottled;
+ } else if (config->input_record_path) {
+  if (!input_recording_begin(config->input_record_path, app_state.fixed_timestep)) {
+   KFATAL("Failed to start input recording to '%s'.", config->input_record_path);
+   return FALSE;
+  }
+  app_state.recording = TRUE;
+ }
+
+ //темп: запись и воспроизведение идут в реальном темпе шага (если не
+ //просили гнать воспроизведение на максимум), иначе - целевая частота
+ if (app_state.replaying || app_state.recording) {
+  app_state.target_frame_time = app_state.unthrottled ? 0 : app_state.fixed_timestep;
+ } else if (config->target_frame_rate > 0) {
+  app_state.target_frame_time = 1.0 / config->target_frame_rate;
+ }
+
  //устанавливаем защиту от повторного вызова
  initialized = TRUE;
  return TRUE;
@@ -114,42 +210,181 @@ b8 application_run() {
 
  //получить сводку по памяти используемой в движке
  KINFO(get_memory_usage_str());
+
+ //при записи и воспроизведении кадр всегда длится ровно fixed_timestep,
+ //иначе прогон не повторится
+ b8 deterministic = app_state.recording || app_state.replaying;
+ clock_start(&app_state.clock);
+ app_state.last_time = 0;
+ app_state.accumulator = 0;
+ f64 next_frame_time = app_state.clock.start_time;
+ u64 frame_count = 0;
  
  while (app_state.is_running) {
+  frame_stats_begin_frame();
+  KPROFILE_BEGIN("frame");
+  KPROFILE_BEGIN("pump");
+
+  //дельта кадра по часам движка
+  clock_update(&app_state.clock);
+  f64 current_time = app_state.clock.elapsed;
+  f64 frame_delta = deterministic ? app_state.fixed_timestep : current_time - app_state.last_time;
+  app_state.last_time = current_time;
+
+  //новый кадр: отчитываемся о заполнении арены и сбрасываем её
+  kreport_peak_usage(MEMORY_TAG_FRAME, app_state.frame_allocator.high_water_mark);
+  linear_allocator_free_all(&app_state.frame_allocator);
 
   //обработка сообщений ОС
   if(!platform_pump_messages(&app_state.platform)) {
    app_state.is_running = FALSE;
   }
 
+  //подаём записанный ввод этого кадра; запись кончилась - выходим
+  if (app_state.replaying) {
+   input_playback_frame();
+   if (input_playback_finished()) {
+    app_state.is_running = FALSE;
+    break;
+   }
+  }
+
+  frame_stats_mark(FRAME_PHASE_PUMP);
+  KPROFILE_END("pump");
+
+  //рассылаем накопленные за кадр события одной пачкой
+  KPROFILE_BEGIN("events");
+  event_dispatch_queued();
+  frame_stats_mark(FRAME_PHASE_EVENTS);
+  KPROFILE_END("events");
+
   //если не приостановлено
   if(!app_state.is_suspended) {
    //обновление игры
-   if (!app_state.game_inst->update(app_state.game_inst, (f32)0)) {
+   KPROFILE_BEGIN("update");
+   f32 alpha = 1.0f;
+   b8 update_ok = TRUE;
+   if (app_state.fixed_update) {
+    //симуляция идёт шагами fixed_timestep, сколько их накопилось
+    app_state.accumulator += frame_delta;
+    u32 steps = 0;
+    while (app_state.accumulator >= app_state.fixed_timestep) {
+     if (steps == app_state.max_catch_up_steps) {
+      //не успеваем: отставание отбрасываем, иначе каждый следующий
+      //кадр будет ещё длиннее
+      u64 behind = (u64)(app_state.accumulator / app_state.fixed_timestep);
+      app_state.accumulator -= (f64)behind * app_state.fixed_timestep;
+      app_state.dropped_steps += behind;
+      break;
+     }
+     if (!app_state.game_inst->update(app_state.game_inst, (f32)app_state.fixed_timestep)) {
+      update_ok = FALSE;
+      break;
+     }
+     app_state.accumulator -= app_state.fixed_timestep;
+     steps++;
+    }
+    //доля следующего шага - для интерполяции состояния при отрисовке
+    alpha = (f32)(app_state.accumulator / app_state.fixed_timestep);
+   } else {
+    update_ok = app_state.game_inst->update(app_state.game_inst, (f32)frame_delta);
+   }
+   if (!update_ok) {
     KFATAL("Game update failed, shutting down.");
     app_state.is_running = FALSE;
     break;
    }
+   frame_stats_mark(FRAME_PHASE_UPDATE);
+   KPROFILE_END("update");
 
    //отрисовка игры, рендер
-   if (!app_state.game_inst->render(app_state.game_inst, (f32)0)) {
+   KPROFILE_BEGIN("render");
+   if (!app_state.game_inst->render(app_state.game_inst, (f32)frame_delta, alpha)) {
     KFATAL("Game render failed, shutting down.");
     app_state.is_running = FALSE;
     break;
    }
+   frame_stats_mark(FRAME_PHASE_RENDER);
+   KPROFILE_END("render");
    // ПРИМЕЧАНИЕ: Обновление ввода / копирование состояния всегда должно выполняться
 // после того, как все входные данные будут записаны; Т.Е. перед этой строкой.
 // В качестве меры предосторожности, ввод — это последнее, что обновляется перед
 // завершением этого кадра.
-  input_update(0);
+  KPROFILE_BEGIN("input");
+  input_update(frame_delta);
+  frame_stats_mark(FRAME_PHASE_INPUT);
+  KPROFILE_END("input");
+  } else {
+   //на паузе время симуляции не копится
+   app_state.accumulator = 0;
+  }
+  frame_count++;
+
+  //держим темп: спим до начала следующего кадра вместо холостого цикла
+  KPROFILE_BEGIN("wait");
+  if (app_state.target_frame_time > 0) {
+   next_frame_time += app_state.target_frame_time;
+   f64 now = platform_get_absolute_time();
+   if (next_frame_time < now - app_state.target_frame_time) {
+    //отстали больше чем на кадр - не пытаемся нагнать пачкой пустых кадров
+    next_frame_time = now;
+   } else {
+    clock_wait_until(next_frame_time);
+   }
   }
+  frame_stats_mark(FRAME_PHASE_WAIT);
+  KPROFILE_END("wait");
+  frame_stats_end_frame();
+  KPROFILE_END("frame");
+
+  //периодическая сводка хронометража
+  if (app_state.frame_stats_log_interval > 0 &&
+      current_time - app_state.last_frame_stats_log >= app_state.frame_stats_log_interval) {
+   KINFO(get_frame_stats_str());
+   app_state.last_frame_stats_log = current_time;
+  }
+ }
+
+ if (app_state.dropped_steps) {
+  KWARN("Simulation fell behind: %llu step(s) dropped.", app_state.dropped_steps);
+ }
+
+ //итог воспроизведения - воспроизводимый замер производительности
+ if (app_state.replaying) {
+  clock_update(&app_state.clock);
+  f64 elapsed = app_state.clock.elapsed;
+  KINFO("Replay finished: %llu frames in %.3f s (%.4f ms/frame).",
+        frame_count, elapsed, frame_count ? elapsed * 1000.0 / (f64)frame_count : 0.0);
+  input_playback_end();
+ }
+ if (app_state.recording) {
+  input_recording_end();
  }
 
  //остановка движка и убираем за собой
  app_state.is_running = FALSE;
+ job_system_shutdown(); //останавливаем рабочие потоки
  event_shutdown();   //закрываем систему событий 
  input_shutdown();   //закрываем систему ввода 
  platform_shutdown(&app_state.platform);
 
+ //освобождаем кадровую арену
+ kfree(app_state.frame_allocator.memory, APPLICATION_FRAME_ALLOCATOR_SIZE, MEMORY_TAG_FRAME);
+ linear_allocator_destroy(&app_state.frame_allocator);
+
+ //трасса профилировщика
+ if (app_state.game_inst->app_config.profile_trace_path) {
+  profiler_stop();
+  profiler_write_trace(app_state.game_inst->app_config.profile_trace_path);
+ }
+
+ //дописываем очередь логгера и останавливаем поток записи
+ shutdown_logging();
+
  return TRUE;
 }
+
+//доступ к кадровой арене из игры (update/render)
+linear_allocator* application_get_frame_allocator() {
+ return &app_state.frame_allocator;
+}
@@ -9,6 +9,7 @@
 #include "defines.h"
 
 struct game;
+struct linear_allocator;
 
 //Конфигурация движка
 typedef struct application_config {
@@ -21,10 +22,51 @@ typedef struct application_config {
  i16 start_height;
  //имя
  char* name;
+
+ //запись ввода в файл (0 - не записывать)
+ const char* input_record_path;
+ //воспроизведение ввода из файла (0 - живой ввод)
+ const char* input_replay_path;
+ //фиксированный шаг симуляции и кадра записи, секунды (0 - 1/60)
+ f64 fixed_timestep;
+ //обновлять игру шагами fixed_timestep (столько раз за кадр, сколько
+ //накопилось времени), render получает долю шага для интерполяции;
+ //FALSE - update раз в кадр с реальной дельтой
+ b8 fixed_update;
+ //сколько шагов симуляции можно догнать за кадр (0 - 5); остальное
+ //отставание отбрасывается
+ u32 max_catch_up_steps;
+ //целевая частота кадров; между кадрами поток спит (0 - без ограничения)
+ f64 target_frame_rate;
+ //рабочих потоков системы задач (0 - по числу ядер минус один)
+ u32 job_worker_count;
+ //как часто выводить в лог сводку хронометража кадров, секунды (0 - никогда)
+ f64 frame_stats_log_interval;
+ //файл трассы профилировщика (Chrome trace JSON): запись зон идёт всю
+ //работу, трасса пишется при завершении (0 - не профилировать)
+ const char* profile_trace_path;
+ //при воспроизведении не ждать реального времени, крутить кадры
+ //так быстро, как позволяет процессор
+ b8 replay_unthrottled;
+ //двоичный лог KDEBUG/KTRACE в файл (0 - текстом, как обычно);
+ //читается утилитой tools/log_decoder
+ const char* binary_log_path;
+ //файл лога (0 - только консоль)
+ const char* log_file_path;
+ //порог ротации файла лога в байтах (0 - без ротации)
+ u64 log_file_max_size;
+ //сколько старых файлов лога хранить (log.1 ... log.N)
+ u32 log_file_max_files;
+ //писать каждый уровень ещё и в свой файл (log.error, log.warn, ...)
+ b8 log_file_per_level;
 } application_config;
 
 //инициализация движка(передаем экземпляр игры, то есть движок запускает игру)
 KAPI b8 application_create(struct game* game_inst);
 
 //запустить движок
-KAPI b8 application_run();
\ No newline at end of file
+KAPI b8 application_run();
+
+//кадровая арена движка: память, выделенная из неё в update/render,
+//действительна до начала следующего кадра, затем сбрасывается целиком
+KAPI struct linear_allocator* application_get_frame_allocator();
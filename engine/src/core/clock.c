@@ -0,0 +1,38 @@
+#include "core/clock.h"
+
+#include "platform/platform.h"
+
+// Сколько секунд до цели ждать активно, а не во сне: сон ОС может
+// проснуться позже запрошенного. На Linux запаздывание - десятки
+// микросекунд, Sleep на Windows без timeBeginPeriod - до такта
+// планировщика
+#if KPLATFORM_WINDOWS
+#define CLOCK_SPIN_MARGIN 0.002
+#else
+#define CLOCK_SPIN_MARGIN 0.0005
+#endif
+
+void clock_update(clock* clock) {
+    if (clock->start_time != 0) {
+        clock->elapsed = platform_get_absolute_time() - clock->start_time;
+    }
+}
+
+void clock_start(clock* clock) {
+    clock->start_time = platform_get_absolute_time();
+    clock->elapsed = 0;
+}
+
+void clock_stop(clock* clock) {
+    clock->start_time = 0;
+}
+
+void clock_wait_until(f64 target_time) {
+    f64 remaining = target_time - platform_get_absolute_time();
+    if (remaining > CLOCK_SPIN_MARGIN) {
+        platform_sleep((u64)((remaining - CLOCK_SPIN_MARGIN) * 1000.0));
+    }
+    // Хвост - активное ожидание
+    while (platform_get_absolute_time() < target_time) {
+    }
+}
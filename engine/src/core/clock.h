@@ -0,0 +1,44 @@
+/*
+  Часы движка на основе platform_get_absolute_time().
+
+  Часы хранят момент запуска и прошедшее с него время. elapsed меняется
+  только в clock_update, поэтому все, кто читает его в течение кадра,
+  видят одно и то же значение.
+*/
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Часы. start_time == 0 - часы остановлены.
+ */
+typedef struct clock {
+    f64 start_time;  // абсолютное время запуска, секунды
+    f64 elapsed;     // секунд с запуска на момент последнего clock_update
+} clock;
+
+/*
+ * Обновляет elapsed. У остановленных часов ничего не делает.
+ * Вызывается раз в кадр, до чтения elapsed.
+ */
+KAPI void clock_update(clock* clock);
+
+/*
+ * Запускает (перезапускает) часы: elapsed обнуляется.
+ */
+KAPI void clock_start(clock* clock);
+
+/*
+ * Останавливает часы. elapsed сохраняет последнее значение.
+ */
+KAPI void clock_stop(clock* clock);
+
+/*
+ * Ждёт наступления абсолютного времени target_time.
+ *
+ * Большая часть ожидания - platform_sleep (поток не занимает ядро),
+ * последние миллисекунды - активное ожидание, так как сон ОС
+ * просыпается с точностью до такта планировщика.
+ * Если время уже наступило, возвращается сразу.
+ */
+KAPI void clock_wait_until(f64 target_time);
@@ -1,6 +1,12 @@
 #include "core/event.h"
 #include "core/kmemory.h"
 #include "containers/darray.h"
+#include "containers/mpsc_queue.h"
+#include "memory/linear_allocator.h"
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "platform/platform.h"
+#include "platform/atomic.h"
 
 /*
  * Структура зарегистрированного события.
@@ -11,31 +17,143 @@ typedef struct registered_event {
     PFN_on_event callback; // Функция-обработчик события
 } registered_event;
 
+/*
+ * Холодные данные слушателя: приоритет и статистика.
+ * Лежат в параллельном массиве state.listener_info по тем же индексам,
+ * чтобы цикл рассылки проходил по плотным 16-байтным записям.
+ */
+typedef struct listener_info {
+    i32 priority;          // Приоритет (больше - раньше)
+    u64 call_count;        // Сколько раз вызывался
+    u64 consumed_count;    // Сколько раз вернул TRUE (прервал рассылку)
+    f64 total_time;        // Суммарное время в обработчике, секунды
+} listener_info;
+
 /*
  * Запись для кода события.
- * Содержит динамический массив зарегистрированных обработчиков.
+ * Все слушатели всех кодов лежат в одном массиве state.listeners,
+ * сгруппированные по коду; запись хранит диапазон своего кода.
  */
 typedef struct event_code_entry {
-    registered_event* events; // Динамический массив registered_event
+    u16 code;   // код события
+    u32 first;  // индекс первого слушателя в state.listeners
+    u32 count;  // количество слушателей
+
+    // Статистика рассылки
+    u64 fire_count;       // вызовов event_fire с этим кодом
+    u64 early_out_count;  // рассылок, прерванных обработчиком
+    f64 total_time;       // суммарное время в обработчиках, секунды
 } event_code_entry;
 
-// Максимальное количество кодов событий (16384 = 2^14)
-#define MAX_MESSAGE_CODES 16384
+/*
+ * Ячейка множества регистраций (code, listener, callback).
+ * Позволяет найти дубликат или регистрацию для удаления за O(1).
+ */
+typedef struct registration_slot {
+    void* listener;
+    PFN_on_event callback;
+    u16 code;
+    u8 status;  // REGISTRATION_SLOT_*
+} registration_slot;
+
+enum {
+    REGISTRATION_SLOT_EMPTY = 0,  // никогда не занималась - конец цепочки поиска
+    REGISTRATION_SLOT_USED,       // занята
+    REGISTRATION_SLOT_DELETED     // была занята (надгробие), поиск идёт дальше
+};
+
+// Начальные ёмкости хэш-таблиц (степени двойки)
+#define EVENT_CODE_TABLE_INITIAL_CAPACITY 64
+#define EVENT_REGISTRATION_TABLE_INITIAL_CAPACITY 128
+
+// Ёмкость очереди отложенных событий (степень двойки)
+#define EVENT_QUEUE_CAPACITY 4096
+
+// Ёмкость очереди событий от других потоков
+#define EVENT_THREAD_QUEUE_CAPACITY 8192
+
+// Размер одной половины арены данных событий
+#define EVENT_PAYLOAD_ARENA_SIZE (256 * 1024)
+
+// Нет стоящего в очереди события с этим кодом
+#define EVENT_QUEUE_NO_SLOT 0xFFFFFFFF
+
+/*
+ * Событие, ожидающее рассылки.
+ */
+typedef struct queued_event {
+    u16 code;
+    void* sender;
+    event_context context;
+} queued_event;
+
+/*
+ * Кольцевой буфер отложенных событий.
+ * head и tail растут монотонно, позиция в буфере - по маске ёмкости.
+ */
+typedef struct event_queue {
+    queued_event* entries;  // EVENT_QUEUE_CAPACITY элементов
+    u32 head;               // следующее событие на рассылку
+    u32 tail;               // следующая свободная позиция
+    // Позиция стоящего в очереди события для каждого системного кода
+    // (для слияния), или EVENT_QUEUE_NO_SLOT
+    u32 pending_slot[MAX_EVENT_CODE + 1];
+    // Коды, для которых включено слияние
+    b8 coalesce[MAX_EVENT_CODE + 1];
+} event_queue;
 
 /*
  * Состояние системы событий.
- * Использует таблицу поиска (lookup table) для быстрого доступа по коду события.
+ * Вместо таблицы на все возможные коды - разреженный реестр:
+ * хэш-таблица "код -> запись" и общий непрерывный массив слушателей.
  */
 typedef struct event_system_state {
-    // Таблица зарегистрированных событий, индексированная по коду события
-    event_code_entry registered[MAX_MESSAGE_CODES];
+    // Все слушатели, сгруппированные по коду (darray)
+    registered_event* listeners;
+    // Приоритеты и статистика слушателей (darray, индексы как у listeners)
+    listener_info* listener_info;
+    // Записи кодов, у которых когда-либо были слушатели (darray)
+    event_code_entry* codes;
+
+    // Хэш-таблица: код -> индекс в codes + 1 (0 - пустая ячейка)
+    u32* code_table;
+    u32 code_table_capacity;
+
+    // Хэш-множество регистраций (открытая адресация, линейное пробирование)
+    registration_slot* registrations;
+    u32 registration_capacity;
+    u32 registration_occupied;  // занятые ячейки + надгробия
+
+    // Увеличивается при каждом изменении реестра - event_fire по нему
+    // замечает регистрации/отмены, сделанные из обработчика
+    u32 registry_version;
+
+    // Замерять время обработчиков (platform_get_absolute_time на вызов)
+    b8 timing_enabled;
+
+    // Очередь отложенных событий (event_post)
+    event_queue queue;
+
+    // Lock-free очередь событий от других потоков (event_post_threadsafe).
+    // Разбирается главным потоком в event_dispatch_queued
+    mpsc_queue thread_queue;
+
+    // Арена данных событий (event_payload_allocate), две половины.
+    // В текущую пишут отправители, предыдущая ещё читается получателями.
+    // Половины меняются в начале каждой рассылки очереди
+    void* payload_memory;
+    linear_allocator payload_arenas[2];
+    u32 payload_generation;  // номер текущего поколения; половина = поколение & 1
+    u32 dispatch_depth;      // глубина вложенности event_dispatch_queued
 } event_system_state;
 
 /*
  * Внутреннее состояние системы событий.
  * static - ограничивает видимость пределами этого файла.
  */
-static b8 is_initialized = FALSE;      // Флаг инициализации системы
+// Флаг инициализации системы. Атомарный: его читает event_post_threadsafe
+// из любого потока; остальные функции - только главный поток (relaxed)
+static atomic_u32 is_initialized = {FALSE};
 static event_system_state state;       // Экземпляр состояния системы
 
 /*
@@ -48,18 +166,50 @@ static event_system_state state;       // Экземпляр состояния
  */
 b8 event_initialize() {
     // Защита от повторной инициализации
-    if (is_initialized == TRUE) {
+    if (atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == TRUE) {
         return FALSE;
     }
     
     // Сначала сбрасываем флаг (на случай ошибки)
-    is_initialized = FALSE;
+    atomic_store_u32(&is_initialized, FALSE, ATOMIC_ORDER_RELAXED);
     
     // Обнуляем всё состояние системы
     kzero_memory(&state, sizeof(state));
     
+    // Реестр слушателей
+    state.listeners = darray_create(registered_event);
+    state.listener_info = darray_create(listener_info);
+    state.codes = darray_create(event_code_entry);
+    state.code_table_capacity = EVENT_CODE_TABLE_INITIAL_CAPACITY;
+    state.code_table = kallocate(sizeof(u32) * state.code_table_capacity, MEMORY_TAG_DICT);
+    state.registration_capacity = EVENT_REGISTRATION_TABLE_INITIAL_CAPACITY;
+    state.registrations = kallocate(sizeof(registration_slot) * state.registration_capacity, MEMORY_TAG_DICT);
+    
+    // Очередь отложенных событий
+    state.queue.entries = kallocate_ex(sizeof(queued_event) * EVENT_QUEUE_CAPACITY, 0, MEMORY_TAG_RING_QUEUE, KALLOCATE_FLAG_NO_ZERO);
+    for (u32 i = 0; i <= MAX_EVENT_CODE; ++i) {
+        state.queue.pending_slot[i] = EVENT_QUEUE_NO_SLOT;
+    }
+    state.queue.coalesce[EVENT_CODE_MOUSE_MOVED] = TRUE;
+    state.queue.coalesce[EVENT_CODE_RESIZED] = TRUE;
+    
+#ifdef _DEBUG
+    state.timing_enabled = TRUE;
+#endif
+    
+    // Арена данных событий: один блок на обе половины. Тег - как у блоков
+    // линейных аллокаторов: FRAME означает только кадровую арену приложения
+    state.payload_memory = kallocate_ex(EVENT_PAYLOAD_ARENA_SIZE * 2, 0, MEMORY_TAG_LINEAR_ALLOCATOR, KALLOCATE_FLAG_NO_ZERO);
+    linear_allocator_create(EVENT_PAYLOAD_ARENA_SIZE, state.payload_memory, &state.payload_arenas[0]);
+    linear_allocator_create(EVENT_PAYLOAD_ARENA_SIZE, (u8*)state.payload_memory + EVENT_PAYLOAD_ARENA_SIZE, &state.payload_arenas[1]);
+    
+    if (!mpsc_queue_create(EVENT_THREAD_QUEUE_CAPACITY, sizeof(queued_event), &state.thread_queue)) {
+        return FALSE;
+    }
+    
     // Устанавливаем флаг успешной инициализации
-    is_initialized = TRUE;
+    // release: потоки, увидевшие флаг, видят и созданные очереди
+    atomic_store_u32(&is_initialized, TRUE, ATOMIC_ORDER_RELEASE);
     
     return TRUE;
 }
@@ -69,49 +219,216 @@ b8 event_initialize() {
  * Освобождает все динамически выделенные ресурсы.
  */
 void event_shutdown() {
-    // Освобождаем массивы событий для каждого кода
-    for(u16 i = 0; i < MAX_MESSAGE_CODES; ++i){
-        // Проверяем, есть ли зарегистрированные события для этого кода
-        if(state.registered[i].events != 0) {
-            // Уничтожаем динамический массив (освобождаем память)
-            darray_destroy(state.registered[i].events);
-            // Обнуляем указатель (защита от повторного освобождения)
-            state.registered[i].events = 0;
+    // Освобождаем реестр: несколько блоков вне зависимости от числа кодов
+    if (state.listeners) {
+        darray_destroy(state.listeners);
+        darray_destroy(state.listener_info);
+        darray_destroy(state.codes);
+        kfree(state.code_table, sizeof(u32) * state.code_table_capacity, MEMORY_TAG_DICT);
+        kfree(state.registrations, sizeof(registration_slot) * state.registration_capacity, MEMORY_TAG_DICT);
+        state.listeners = 0;
+        state.listener_info = 0;
+        state.codes = 0;
+        state.code_table = 0;
+        state.registrations = 0;
+    }
+    
+    // Освобождаем очередь (неразосланные события теряются)
+    if (state.queue.entries) {
+        kfree(state.queue.entries, sizeof(queued_event) * EVENT_QUEUE_CAPACITY, MEMORY_TAG_RING_QUEUE);
+        state.queue.entries = 0;
+    }
+    mpsc_queue_destroy(&state.thread_queue);
+    if (state.payload_memory) {
+        linear_allocator_destroy(&state.payload_arenas[0]);
+        linear_allocator_destroy(&state.payload_arenas[1]);
+        kfree(state.payload_memory, EVENT_PAYLOAD_ARENA_SIZE * 2, MEMORY_TAG_LINEAR_ALLOCATOR);
+        state.payload_memory = 0;
+    }
+    atomic_store_u32(&is_initialized, FALSE, ATOMIC_ORDER_RELAXED);
+}
+
+//перемешивание битов для хэша (финализатор murmur3)
+static inline u64 event_hash(u64 x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+//хэш регистрации (code, listener, callback)
+static inline u64 registration_hash(u16 code, void* listener, PFN_on_event callback) {
+    return event_hash((u64)listener ^ event_hash((u64)callback) ^ ((u64)code << 48));
+}
+
+/*
+ * Ищет запись кода. Возвращает 0, если у кода никогда не было слушателей.
+ */
+static event_code_entry* event_code_find(u16 code) {
+    u32 mask = state.code_table_capacity - 1;
+    for (u32 i = (u32)event_hash(code) & mask;; i = (i + 1) & mask) {
+        u32 slot = state.code_table[i];
+        if (slot == 0) {
+            return 0;
+        }
+        if (state.codes[slot - 1].code == code) {
+            return &state.codes[slot - 1];
         }
     }
 }
 
+/*
+ * Вставляет индекс записи в таблицу кодов (без проверки на наличие).
+ */
+static void event_code_table_insert(u16 code, u32 index) {
+    u32 mask = state.code_table_capacity - 1;
+    u32 i = (u32)event_hash(code) & mask;
+    while (state.code_table[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    state.code_table[i] = index + 1;
+}
+
+/*
+ * Возвращает запись кода, создавая её при необходимости.
+ * Новый код получает пустой диапазон в конце массива слушателей.
+ */
+static event_code_entry* event_code_get_or_add(u16 code) {
+    event_code_entry* entry = event_code_find(code);
+    if (entry) {
+        return entry;
+    }
+    
+    event_code_entry new_entry;
+    new_entry.code = code;
+    new_entry.first = (u32)darray_length(state.listeners);
+    new_entry.count = 0;
+    new_entry.fire_count = 0;
+    new_entry.early_out_count = 0;
+    new_entry.total_time = 0;
+    darray_push(state.codes, new_entry);
+    u32 code_count = (u32)darray_length(state.codes);
+    
+    // Держим заполнение таблицы не выше половины - перестраиваем с удвоением
+    if (code_count * 2 > state.code_table_capacity) {
+        kfree(state.code_table, sizeof(u32) * state.code_table_capacity, MEMORY_TAG_DICT);
+        state.code_table_capacity *= 2;
+        state.code_table = kallocate(sizeof(u32) * state.code_table_capacity, MEMORY_TAG_DICT);
+        for (u32 i = 0; i < code_count; ++i) {
+            event_code_table_insert(state.codes[i].code, i);
+        }
+    } else {
+        event_code_table_insert(code, code_count - 1);
+    }
+    return &state.codes[code_count - 1];
+}
+
+/*
+ * Ищет регистрацию. Возвращает ячейку или 0.
+ */
+static registration_slot* registration_find(u16 code, void* listener, PFN_on_event callback) {
+    u32 mask = state.registration_capacity - 1;
+    for (u32 i = (u32)registration_hash(code, listener, callback) & mask;; i = (i + 1) & mask) {
+        registration_slot* slot = &state.registrations[i];
+        if (slot->status == REGISTRATION_SLOT_EMPTY) {
+            return 0;
+        }
+        if (slot->status == REGISTRATION_SLOT_USED && slot->code == code &&
+            slot->listener == listener && slot->callback == callback) {
+            return slot;
+        }
+    }
+}
+
+/*
+ * Добавляет регистрацию в множество (её там ещё нет).
+ */
+static void registration_insert(u16 code, void* listener, PFN_on_event callback) {
+    // Надгробия тоже удлиняют поиск, поэтому считаем их в заполнении.
+    // При перестройке надгробия выбрасываются
+    if ((state.registration_occupied + 1) * 2 > state.registration_capacity) {
+        registration_slot* old_slots = state.registrations;
+        u32 old_capacity = state.registration_capacity;
+        u32 live = 0;
+        for (u32 i = 0; i < old_capacity; ++i) {
+            live += old_slots[i].status == REGISTRATION_SLOT_USED;
+        }
+        while ((live + 1) * 2 > state.registration_capacity) {
+            state.registration_capacity *= 2;
+        }
+        state.registrations = kallocate(sizeof(registration_slot) * state.registration_capacity, MEMORY_TAG_DICT);
+        state.registration_occupied = 0;
+        for (u32 i = 0; i < old_capacity; ++i) {
+            if (old_slots[i].status == REGISTRATION_SLOT_USED) {
+                registration_insert(old_slots[i].code, old_slots[i].listener, old_slots[i].callback);
+            }
+        }
+        kfree(old_slots, sizeof(registration_slot) * old_capacity, MEMORY_TAG_DICT);
+    }
+    
+    u32 mask = state.registration_capacity - 1;
+    u32 i = (u32)registration_hash(code, listener, callback) & mask;
+    while (state.registrations[i].status == REGISTRATION_SLOT_USED) {
+        i = (i + 1) & mask;
+    }
+    registration_slot* slot = &state.registrations[i];
+    if (slot->status == REGISTRATION_SLOT_EMPTY) {
+        state.registration_occupied++;
+    }
+    slot->listener = listener;
+    slot->callback = callback;
+    slot->code = code;
+    slot->status = REGISTRATION_SLOT_USED;
+}
+
+/*
+ * Сдвигает начало диапазонов всех кодов, лежащих после позиции index,
+ * на delta (+1 при вставке, -1 при удалении слушателя).
+ */
+static void event_codes_shift(event_code_entry* except, u32 index, i32 delta) {
+    u64 code_count = darray_length(state.codes);
+    for (u64 i = 0; i < code_count; ++i) {
+        event_code_entry* entry = &state.codes[i];
+        if (entry != except && entry->first >= index && (delta > 0 || entry->first > index)) {
+            entry->first += delta;
+        }
+    }
+}
+
+/*
+ * Регистрирует обработчик с обычным приоритетом.
+ */
+b8 event_register(u16 code, void* listener, PFN_on_event on_event) {
+    return event_register_ex(code, listener, on_event, EVENT_PRIORITY_DEFAULT);
+}
+
 /*
  * Регистрирует обработчик для определённого кода события.
+ * Слушатели кода хранятся отсортированными по убыванию приоритета,
+ * поэтому сортировка делается один раз здесь, а не при каждой рассылке.
  * 
  * Параметры:
  *   code      - код события для прослушивания
  *   listener  - указатель на объект-слушатель
  *   on_event  - функция-обработчик
+ *   priority  - приоритет (больше - раньше)
  * 
  * Возвращает:
  *   TRUE  - успешная регистрация
  *   FALSE - система не инициализирована, дубликат или ошибка
  */
-b8 event_register(u16 code, void* listener, PFN_on_event on_event) {
+b8 event_register_ex(u16 code, void* listener, PFN_on_event on_event, i32 priority) {
     // Проверка инициализации системы
-    if(is_initialized == FALSE) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
         return FALSE;
     }
     
-    // Если для этого кода ещё нет массива обработчиков - создаём его
-    if(state.registered[code].events == 0) {
-        state.registered[code].events = darray_create(registered_event);
-    }
-    
-    // Проверяем, нет ли уже такой же регистрации
-    u64 registered_count = darray_length(state.registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        // Ищем совпадение по listener (объекту-слушателю)
-        if(state.registered[code].events[i].listener == listener) {
-            // TODO: добавить предупреждение в лог
-            return FALSE; // Дубликат найден
-        }
+    // Проверяем, нет ли уже такой же регистрации (O(1) по хэшу)
+    if(registration_find(code, listener, on_event)) {
+        KWARN("event_register - listener is already registered for code %u.", code);
+        return FALSE;
     }
     
     // Дубликатов не найдено - создаём новую регистрацию
@@ -119,9 +436,26 @@ b8 event_register(u16 code, void* listener, PFN_on_event on_event) {
     event.listener = listener;    // Сохраняем указатель на слушателя
     event.callback = on_event;    // Сохраняем указатель на функцию
     
-    // Добавляем в динамический массив для этого кода события
-    darray_push(state.registered[code].events, event);
+    listener_info info;
+    kzero_memory(&info, sizeof(info));
+    info.priority = priority;
+    
+    // Вставляем после всех слушателей с приоритетом не ниже нашего:
+    // при равных приоритетах сохраняется порядок регистрации.
+    // Диапазоны кодов после точки вставки сдвигаются
+    event_code_entry* entry = event_code_get_or_add(code);
+    u32 index = entry->first;
+    u32 end = entry->first + entry->count;
+    while (index < end && state.listener_info[index].priority >= priority) {
+        index++;
+    }
+    darray_insert_range(state.listeners, index, &event, 1);
+    darray_insert_range(state.listener_info, index, &info, 1);
+    entry->count++;
+    event_codes_shift(entry, index, 1);
+    state.registry_version++;
     
+    registration_insert(code, listener, on_event);
     return TRUE; // Успешная регистрация
 }
 
@@ -139,37 +473,43 @@ b8 event_register(u16 code, void* listener, PFN_on_event on_event) {
  */
 b8 event_unregister(u16 code, void* listener, PFN_on_event on_event) {
     // Проверка инициализации системы
-    if(is_initialized == FALSE) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
         return FALSE;
     }
     
-    // Если для этого кода нет зарегистрированных событий - выходим
-    if(state.registered[code].events == 0) {
-        // TODO: добавить предупреждение в лог
+    registration_slot* slot = registration_find(code, listener, on_event);
+    if(!slot) {
+        KWARN("event_unregister - no such registration for code %u.", code);
         return FALSE;
     }
+    slot->status = REGISTRATION_SLOT_DELETED;
     
-    // Ищем точное совпадение listener + callback
-    u64 registered_count = darray_length(state.registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        registered_event e = state.registered[code].events[i];
+    // Ищем точное совпадение listener + callback в диапазоне кода
+    event_code_entry* entry = event_code_find(code);
+    for(u32 i = entry->first; i < entry->first + entry->count; ++i) {
+        registered_event e = state.listeners[i];
         
         // Проверяем полное совпадение
         if(e.listener == listener && e.callback == on_event) {
-            // Нашли - удаляем из массива
-            registered_event popped_event;
-            darray_pop_at(state.registered[code].events, i, &popped_event);
+            // Нашли - удаляем из массива, порядок остальных сохраняется
+            darray_remove_range(state.listeners, i, 1, 0);
+            darray_remove_range(state.listener_info, i, 1, 0);
+            entry->count--;
+            event_codes_shift(entry, i, -1);
+            state.registry_version++;
             return TRUE; // Успешное удаление
         }
     }
     
-    // Совпадение не найдено
+    // Множество и массив рассинхронизированы - такого быть не должно
+    KERROR("event_unregister - registry is inconsistent for code %u.", code);
     return FALSE;
 }
 
 /*
  * Вызывает (отправляет) событие всем зарегистрированным обработчикам.
- * Обработчики вызываются в порядке регистрации.
+ * Обработчики вызываются по убыванию приоритета, при равном приоритете -
+ * в порядке регистрации.
  * 
  * Параметры:
  *   code    - код события для отправки
@@ -180,26 +520,60 @@ b8 event_unregister(u16 code, void* listener, PFN_on_event on_event) {
  *   TRUE  - событие было обработано (какой-то обработчик вернул TRUE)
  *   FALSE - система не инициализирована, нет обработчиков или никто не обработал
  */
-b8 event_fire(u16 code, void* sender, event_context context) {
-    // Проверка инициализации системы
-    if(is_initialized == FALSE) {
-        return FALSE;
-    }
+//вызывает обработчиков entry по очереди до первого, вернувшего TRUE
+static b8 event_call_listeners(event_code_entry* entry, u16 code, void* sender, event_context context) {
+    entry->fire_count++;
     
-    // Если для этого кода нет зарегистрированных обработчиков
-    if(state.registered[code].events == 0) {
-        return FALSE;
-    }
+    b8 timing = state.timing_enabled;
+    u32 version = state.registry_version;
     
     // Вызываем все зарегистрированные обработчики
-    u64 registered_count = darray_length(state.registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        registered_event e = state.registered[code].events[i];
+    for(u32 i = 0; i < entry->count; ++i) {
+        u32 index = entry->first + i;
+        registered_event e = state.listeners[index];
         
         // Вызываем callback-функцию
-        if(e.callback(code, sender, e.listener, context)) {
+        f64 start_time = timing ? platform_get_absolute_time() : 0;
+        b8 consumed = e.callback(code, sender, e.listener, context);
+        f64 elapsed = timing ? platform_get_absolute_time() - start_time : 0;
+        
+        if(state.registry_version != version) {
+            // Обработчик изменил реестр: массивы могли переехать, а слушатели
+            // сдвинуться. Берём запись заново и находим вызванного слушателя
+            version = state.registry_version;
+            entry = event_code_find(code);
+            u32 position = entry->count;
+            for(u32 j = 0; j < entry->count; ++j) {
+                registered_event* moved = &state.listeners[entry->first + j];
+                if(moved->callback == e.callback && moved->listener == e.listener) {
+                    position = j;
+                    break;
+                }
+            }
+            if(position == entry->count) {
+                // Слушатель отменил свою регистрацию: на его место сдвинулся
+                // следующий, продолжаем с той же позиции без статистики
+                if(consumed) {
+                    entry->early_out_count++;
+                    return TRUE;
+                }
+                i--;
+                continue;
+            }
+            i = position;
+            index = entry->first + i;
+        }
+        
+        listener_info* info = &state.listener_info[index];
+        info->call_count++;
+        info->total_time += elapsed;
+        entry->total_time += elapsed;
+        
+        if(consumed) {
             // Обработчик вернул TRUE - событие обработано
             // Не вызываем остальные обработчики (цепочка прерывается)
+            info->consumed_count++;
+            entry->early_out_count++;
             return TRUE;
         }
         // Если обработчик вернул FALSE - продолжаем цепочку
@@ -207,4 +581,266 @@ b8 event_fire(u16 code, void* sender, event_context context) {
     
     // Ни один обработчик не вернул TRUE (или обработчиков не было)
     return FALSE;
-} 
\ No newline at end of file
+}
+
+b8 event_fire(u16 code, void* sender, event_context context) {
+    // Проверка инициализации системы
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
+        return FALSE;
+    }
+    
+    // Если для этого кода нет зарегистрированных обработчиков
+    event_code_entry* entry = event_code_find(code);
+    if(!entry || entry->count == 0) {
+        return FALSE;
+    }
+
+    KPROFILE_BEGIN("event_fire");
+    b8 consumed = event_call_listeners(entry, code, sender, context);
+    KPROFILE_END("event_fire");
+    return consumed;
+}
+
+/*
+ * Возвращает статистику рассылки для кода события.
+ */
+b8 event_get_code_stats(u16 code, event_code_stats* out_stats) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE || !out_stats) {
+        return FALSE;
+    }
+    event_code_entry* entry = event_code_find(code);
+    if(!entry) {
+        return FALSE;
+    }
+    out_stats->listener_count = entry->count;
+    out_stats->fire_count = entry->fire_count;
+    out_stats->early_out_count = entry->early_out_count;
+    out_stats->total_time = entry->total_time;
+    return TRUE;
+}
+
+/*
+ * Копирует статистику слушателей кода в порядке их вызова.
+ */
+u32 event_get_listener_stats(u16 code, event_listener_stats* out_stats, u32 max_count) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
+        return 0;
+    }
+    event_code_entry* entry = event_code_find(code);
+    if(!entry) {
+        return 0;
+    }
+    if(!out_stats) {
+        return entry->count;
+    }
+    
+    u32 count = entry->count < max_count ? entry->count : max_count;
+    for(u32 i = 0; i < count; ++i) {
+        registered_event* e = &state.listeners[entry->first + i];
+        listener_info* info = &state.listener_info[entry->first + i];
+        out_stats[i].listener = e->listener;
+        out_stats[i].callback = e->callback;
+        out_stats[i].priority = info->priority;
+        out_stats[i].call_count = info->call_count;
+        out_stats[i].consumed_count = info->consumed_count;
+        out_stats[i].total_time = info->total_time;
+    }
+    return count;
+}
+
+/*
+ * Обнуляет статистику всех кодов и слушателей.
+ */
+void event_reset_stats() {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
+        return;
+    }
+    u64 code_count = darray_length(state.codes);
+    for(u64 i = 0; i < code_count; ++i) {
+        state.codes[i].fire_count = 0;
+        state.codes[i].early_out_count = 0;
+        state.codes[i].total_time = 0;
+    }
+    u64 listener_count = darray_length(state.listener_info);
+    for(u64 i = 0; i < listener_count; ++i) {
+        state.listener_info[i].call_count = 0;
+        state.listener_info[i].consumed_count = 0;
+        state.listener_info[i].total_time = 0;
+    }
+}
+
+/*
+ * Включает или выключает замер времени обработчиков.
+ */
+void event_set_timing(b8 enabled) {
+    state.timing_enabled = enabled;
+}
+
+/*
+ * Кладёт событие в кольцевой буфер или сливает его с уже стоящим.
+ * 
+ * Возвращает:
+ *   FALSE - буфер заполнен, событие не поставлено
+ */
+static b8 event_queue_enqueue(event_queue* queue, u16 code, void* sender, event_context context) {
+    // Слияние: событие с этим кодом ещё ждёт рассылки - просто обновляем данные
+    b8 coalesce = code <= MAX_EVENT_CODE && queue->coalesce[code];
+    if(coalesce && queue->pending_slot[code] != EVENT_QUEUE_NO_SLOT) {
+        queued_event* pending = &queue->entries[queue->pending_slot[code] & (EVENT_QUEUE_CAPACITY - 1)];
+        pending->sender = sender;
+        pending->context = context;
+        return TRUE;
+    }
+    
+    if(queue->tail - queue->head == EVENT_QUEUE_CAPACITY) {
+        return FALSE;
+    }
+    
+    queued_event* entry = &queue->entries[queue->tail & (EVENT_QUEUE_CAPACITY - 1)];
+    entry->code = code;
+    entry->sender = sender;
+    entry->context = context;
+    if(coalesce) {
+        queue->pending_slot[code] = queue->tail;
+    }
+    queue->tail++;
+    return TRUE;
+}
+
+/*
+ * Ставит событие в очередь главного потока.
+ */
+b8 event_post(u16 code, void* sender, event_context context) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
+        return FALSE;
+    }
+    
+    if(!event_queue_enqueue(&state.queue, code, sender, context)) {
+        // Очередь заполнена - рассылаем накопленное сейчас, чтобы не терять события
+        KWARN("event_post - event queue is full, dispatching %u events immediately.", EVENT_QUEUE_CAPACITY);
+        event_dispatch_queued();
+        event_queue_enqueue(&state.queue, code, sender, context);
+    }
+    return TRUE;
+}
+
+/*
+ * Ставит событие в lock-free очередь. Безопасно из любого потока.
+ */
+b8 event_post_threadsafe(u16 code, void* sender, event_context context) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_ACQUIRE) == FALSE) {
+        return FALSE;
+    }
+    queued_event e;
+    e.code = code;
+    e.sender = sender;
+    e.context = context;
+    return mpsc_queue_push(&state.thread_queue, &e);
+}
+
+/*
+ * Разбирает очередь одним проходом.
+ * Верхняя граница фиксируется заранее, поэтому события, поставленные
+ * обработчиками во время рассылки, не продлевают текущий кадр.
+ */
+u32 event_dispatch_queued() {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
+        return 0;
+    }
+    event_queue* queue = &state.queue;
+    
+    // Меняем половины арены данных: сбрасывается та, что была заполнена до
+    // прошлой рассылки - все её события уже разосланы. Вложенная рассылка
+    // (переполнение очереди) половины не трогает: данные поставленных в этот
+    // момент событий ещё не доставлены
+    if(state.dispatch_depth == 0) {
+        state.payload_generation++;
+        linear_allocator_free_all(&state.payload_arenas[state.payload_generation & 1]);
+    }
+    state.dispatch_depth++;
+    
+    // Сначала переносим события других потоков в общий буфер (со слиянием).
+    // Они идут после событий главного потока, поставленных до этого момента
+    queued_event incoming;
+    while(queue->tail - queue->head < EVENT_QUEUE_CAPACITY &&
+          mpsc_queue_pop(&state.thread_queue, &incoming)) {
+        event_queue_enqueue(queue, incoming.code, incoming.sender, incoming.context);
+    }
+    
+    u32 end = queue->tail;
+    u32 dispatched = 0;
+    // Сравнение через разность: вложенная рассылка (при переполнении
+    // очереди из обработчика) могла уже уйти дальше end
+    while((i32)(end - queue->head) > 0) {
+        // Копируем событие: обработчик может поставить новое на это же место
+        queued_event e = queue->entries[queue->head & (EVENT_QUEUE_CAPACITY - 1)];
+        if(e.code <= MAX_EVENT_CODE && queue->pending_slot[e.code] == queue->head) {
+            queue->pending_slot[e.code] = EVENT_QUEUE_NO_SLOT;
+        }
+        queue->head++;
+        event_fire(e.code, e.sender, e.context);
+        dispatched++;
+    }
+    state.dispatch_depth--;
+    return dispatched;
+}
+
+/*
+ * Включает/выключает слияние событий для кода.
+ */
+void event_set_coalescing(u16 code, b8 enabled) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE || code > MAX_EVENT_CODE) {
+        return;
+    }
+    state.queue.coalesce[code] = enabled;
+    if(!enabled) {
+        state.queue.pending_slot[code] = EVENT_QUEUE_NO_SLOT;
+    }
+}
+
+/*
+ * Выделяет блок данных события в текущей половине арены.
+ * Дескриптор: u32[0] - смещение, u32[1] - размер, u32[2] - поколение.
+ */
+void* event_payload_allocate(u64 size, event_context* out_context) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE || !out_context) {
+        return 0;
+    }
+    linear_allocator* arena = &state.payload_arenas[state.payload_generation & 1];
+    void* block = linear_allocator_allocate(arena, size);
+    if(!block) {
+        KERROR("event_payload_allocate - payload arena is full (%llu bytes requested).", size);
+        return 0;
+    }
+    out_context->data.u32[0] = (u32)((u8*)block - (u8*)arena->memory);
+    out_context->data.u32[1] = (u32)size;
+    out_context->data.u32[2] = state.payload_generation;
+    return block;
+}
+
+/*
+ * Возвращает блок данных события по дескриптору из контекста.
+ */
+void* event_payload_get(event_context context, u64* out_size) {
+    if(atomic_load_u32(&is_initialized, ATOMIC_ORDER_RELAXED) == FALSE) {
+        return 0;
+    }
+    u32 offset = context.data.u32[0];
+    u32 size = context.data.u32[1];
+    u32 generation = context.data.u32[2];
+    
+    // Живы только текущее и предыдущее поколения
+    if(state.payload_generation - generation > 1) {
+        KWARN("event_payload_get - payload handle is stale (generation %u, current %u).", generation, state.payload_generation);
+        return 0;
+    }
+    linear_allocator* arena = &state.payload_arenas[generation & 1];
+    if((u64)offset + size > arena->allocated) {
+        KWARN("event_payload_get - invalid payload handle.");
+        return 0;
+    }
+    if(out_size) {
+        *out_size = size;
+    }
+    return (u8*)arena->memory + offset;
+}
@@ -44,6 +44,33 @@ typedef struct event_context {
  */
 typedef b8 (*PFN_on_event)(u16 code, void* sender, void* listener_inst, event_context data);
 
+// Приоритеты слушателей: больше - раньше
+#define EVENT_PRIORITY_DEFAULT 0
+#define EVENT_PRIORITY_HIGH 1000
+#define EVENT_PRIORITY_LOW -1000
+
+/*
+ * Статистика рассылки одного кода события.
+ */
+typedef struct event_code_stats {
+    u32 listener_count;   // Текущее количество слушателей
+    u64 fire_count;       // Сколько раз событие рассылалось
+    u64 early_out_count;  // Сколько рассылок прервал какой-то обработчик
+    f64 total_time;       // Суммарное время во всех обработчиках, секунды
+} event_code_stats;
+
+/*
+ * Статистика одного слушателя.
+ */
+typedef struct event_listener_stats {
+    void* listener;
+    PFN_on_event callback;
+    i32 priority;
+    u64 call_count;       // Сколько раз обработчик вызывался
+    u64 consumed_count;   // Сколько раз он вернул TRUE
+    f64 total_time;       // Суммарное время в обработчике, секунды
+} event_listener_stats;
+
 /*
  * Инициализирует систему событий.
  * Должна быть вызвана перед использованием любых функций событий.
@@ -52,13 +79,13 @@ typedef b8 (*PFN_on_event)(u16 code, void* sender, void* listener_inst, event_co
  *   TRUE - инициализация успешна
  *   FALSE - ошибка инициализации
  */
-b8 event_initialize();
+KAPI b8 event_initialize();
 
 /*
  * Завершает работу системы событий.
  * Освобождает все ресурсы, удаляет регистрации.
  */
-void event_shutdown();
+KAPI void event_shutdown();
 
 /**
  * Регистрирует слушателя для определённого кода события.
@@ -75,6 +102,26 @@ void event_shutdown();
  */
 KAPI b8 event_register(u16 code, void* listener, PFN_on_event on_event);
 
+/**
+ * Регистрирует слушателя с явным приоритетом.
+ * Слушатели с большим приоритетом вызываются раньше; при равном
+ * приоритете - в порядке регистрации. Используется для потребителей,
+ * которые должны прервать рассылку до дорогих обработчиков
+ * (например, проверка попадания в UI). event_register регистрирует
+ * с приоритетом EVENT_PRIORITY_DEFAULT.
+ * 
+ * Параметры:
+ *   code - код события для прослушивания
+ *   listener - указатель на экземпляр слушателя (может быть NULL)
+ *   on_event - функция-обработчик события
+ *   priority - приоритет вызова (больше - раньше)
+ * 
+ * Возвращает:
+ *   TRUE - успешная регистрация
+ *   FALSE - ошибка регистрации (дубликат или другая ошибка)
+ */
+KAPI b8 event_register_ex(u16 code, void* listener, PFN_on_event on_event, i32 priority);
+
 /**
  * Отменяет регистрацию слушателя для определённого кода события.
  * 
@@ -91,6 +138,7 @@ KAPI b8 event_unregister(u16 code, void* listener, PFN_on_event on_event);
 
 /**
  * Отправляет (вызывает) событие всем зарегистрированным слушателям.
+ * Слушатели вызываются по убыванию приоритета.
  * Если какой-либо обработчик возвращает TRUE, рассылка прекращается.
  * 
  * Параметры:
@@ -104,6 +152,126 @@ KAPI b8 event_unregister(u16 code, void* listener, PFN_on_event on_event);
  */
 KAPI b8 event_fire(u16 code, void* sender, event_context context);
 
+/**
+ * Возвращает статистику рассылки кода события.
+ * Время копится только при включённом замере (см. event_set_timing).
+ * 
+ * Возвращает:
+ *   TRUE - статистика записана в out_stats
+ *   FALSE - у кода никогда не было слушателей
+ */
+KAPI b8 event_get_code_stats(u16 code, event_code_stats* out_stats);
+
+/**
+ * Копирует статистику слушателей кода в порядке их вызова.
+ * 
+ * Параметры:
+ *   code - код события
+ *   out_stats - массив для результата (NULL - только узнать количество)
+ *   max_count - ёмкость out_stats
+ * 
+ * Возвращает:
+ *   Количество записанных элементов (или количество слушателей, если out_stats равен NULL)
+ */
+KAPI u32 event_get_listener_stats(u16 code, event_listener_stats* out_stats, u32 max_count);
+
+/**
+ * Обнуляет статистику всех кодов и слушателей.
+ */
+KAPI void event_reset_stats();
+
+/**
+ * Включает или выключает замер времени обработчиков.
+ * Стоит двух чтений таймера на вызов; по умолчанию включён в отладочной сборке.
+ */
+KAPI void event_set_timing(b8 enabled);
+
+/**
+ * Ставит событие в очередь отложенной рассылки вместо немедленного вызова.
+ * Очередь разбирается раз в кадр через event_dispatch_queued().
+ * Для кодов с включённым слиянием (см. event_set_coalescing) новое событие
+ * заменяет данные ещё не разосланного события с тем же кодом.
+ * Если очередь переполнена, накопленные события рассылаются сразу.
+ * 
+ * Параметры:
+ *   code - код события
+ *   sender - указатель на отправителя (может быть NULL)
+ *   context - контекст события с данными (копируется)
+ * 
+ * Возвращает:
+ *   TRUE - событие поставлено в очередь (или слито с уже стоящим)
+ *   FALSE - система не инициализирована
+ */
+KAPI b8 event_post(u16 code, void* sender, event_context context);
+
+/**
+ * Потокобезопасная версия event_post: можно вызывать из любого потока.
+ * Событие кладётся в lock-free MPSC очередь без блокировок и доставляется
+ * главным потоком в event_dispatch_queued().
+ * 
+ * Порядок доставки: сначала события, поставленные главным потоком через
+ * event_post, затем события других потоков в порядке их постановки
+ * (события одного потока всегда приходят в том порядке, в каком отправлены).
+ * 
+ * Возвращает:
+ *   TRUE - событие поставлено
+ *   FALSE - система не инициализирована или очередь заполнена
+ *           (отправитель может повторить попытку позже)
+ */
+KAPI b8 event_post_threadsafe(u16 code, void* sender, event_context context);
+
+/**
+ * Рассылает все события, стоявшие в очереди на момент вызова, в порядке
+ * постановки. События, поставленные во время рассылки, уйдут в следующий раз.
+ * Вызывается движком раз в кадр.
+ * 
+ * Возвращает:
+ *   Количество разосланных событий
+ */
+KAPI u32 event_dispatch_queued();
+
+/**
+ * Включает или выключает слияние событий с кодом code в очереди.
+ * Подходит для событий, где важно только последнее значение
+ * (позиция мыши, размер окна). Поддерживается для кодов до MAX_EVENT_CODE.
+ * По умолчанию включено для EVENT_CODE_MOUSE_MOVED и EVENT_CODE_RESIZED.
+ */
+KAPI void event_set_coalescing(u16 code, b8 enabled);
+
+/**
+ * Выделяет блок данных события произвольного размера в арене событий
+ * и записывает его дескриптор в контекст. Используется для данных,
+ * не помещающихся в 16 байт event_context (ввод текста, список файлов).
+ * Освобождать блок не нужно: арена сбрасывается сама.
+ * 
+ * Время жизни: блок действителен до конца следующего вызова
+ * event_dispatch_queued(), то есть переживает доставку как через
+ * event_fire, так и через event_post. Получатель, которому данные нужны
+ * дольше, должен их скопировать.
+ * 
+ * Дескриптор занимает u32[0..2] контекста; u32[3] остаётся отправителю
+ * (например, количество элементов). Только для главного потока.
+ * 
+ * Параметры:
+ *   size - размер блока в байтах (выравнивание 16)
+ *   out_context - контекст, в который записывается дескриптор
+ * 
+ * Возвращает:
+ *   Указатель на блок для заполнения, или 0, если арена заполнена
+ */
+KAPI void* event_payload_allocate(u64 size, event_context* out_context);
+
+/**
+ * Возвращает блок данных события по дескриптору из контекста.
+ * 
+ * Параметры:
+ *   context - контекст события, заполненный event_payload_allocate
+ *   out_size - (необязательно) размер блока
+ * 
+ * Возвращает:
+ *   Указатель на блок, или 0, если дескриптор устарел или неверен
+ */
+KAPI void* event_payload_get(event_context context, u64* out_size);
 
 /*
  * Системные коды событий (внутренние для движка).
@@ -0,0 +1,119 @@
+#include "core/frame_stats.h"
+
+#include "platform/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Состояние хронометража. Пишет только поток игрового цикла.
+ * Длительности хранятся в f32: точности (доли микросекунды на кадрах
+ * до секунды) хватает, а буфер вдвое меньше.
+ */
+typedef struct frame_stats_state {
+    f64 last_mark;                       // время предыдущей отметки
+    f64 frame_start;                     // время начала текущего кадра
+    f64 current[FRAME_PHASE_MAX];        // фазы текущего кадра
+    f32 history[FRAME_PHASE_MAX][FRAME_STATS_HISTORY];
+    u64 frame_count;                     // завершённых кадров всего
+    char text[1024];                     // буфер get_frame_stats_str
+} frame_stats_state;
+
+static frame_stats_state state;
+
+// Названия фаз для таблицы (выровнены)
+static const char* phase_strings[FRAME_PHASE_MAX] = {
+    "PUMP  ",
+    "EVENTS",
+    "UPDATE",
+    "RENDER",
+    "INPUT ",
+    "WAIT  ",
+    "FRAME "
+};
+
+void frame_stats_begin_frame() {
+    state.frame_start = platform_get_absolute_time();
+    state.last_mark = state.frame_start;
+    for (u32 i = 0; i < FRAME_PHASE_MAX; ++i) {
+        state.current[i] = 0;
+    }
+}
+
+void frame_stats_mark(frame_phase phase) {
+    f64 now = platform_get_absolute_time();
+    state.current[phase] += now - state.last_mark;
+    state.last_mark = now;
+}
+
+void frame_stats_end_frame() {
+    // Кадр целиком - от начала до последней отметки (обычно после ожидания)
+    state.current[FRAME_PHASE_FRAME] = state.last_mark - state.frame_start;
+    u32 index = (u32)(state.frame_count & (FRAME_STATS_HISTORY - 1));
+    for (u32 i = 0; i < FRAME_PHASE_MAX; ++i) {
+        state.history[i][index] = (f32)state.current[i];
+    }
+    state.frame_count++;
+}
+
+//сравнение для qsort
+static int compare_f32(const void* a, const void* b) {
+    f32 left = *(const f32*)a;
+    f32 right = *(const f32*)b;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+//перцентиль p (0..1) отсортированного массива, метод ближайшего ранга
+static f64 percentile(const f32* sorted, u32 count, f64 p) {
+    u32 rank = (u32)(p * count + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+u32 frame_stats_get(frame_phase phase, frame_phase_stats* out_stats) {
+    u32 count = state.frame_count < FRAME_STATS_HISTORY ? (u32)state.frame_count : FRAME_STATS_HISTORY;
+    if (count == 0 || phase >= FRAME_PHASE_MAX) {
+        out_stats->average = out_stats->p50 = out_stats->p95 = out_stats->p99 = out_stats->max = 0;
+        return 0;
+    }
+
+    // Сортируем копию: порядок в кольце нужен для следующих кадров
+    f32 sorted[FRAME_STATS_HISTORY];
+    f64 sum = 0;
+    for (u32 i = 0; i < count; ++i) {
+        sorted[i] = state.history[phase][i];
+        sum += sorted[i];
+    }
+    qsort(sorted, count, sizeof(f32), compare_f32);
+
+    out_stats->average = sum / count;
+    out_stats->p50 = percentile(sorted, count, 0.50);
+    out_stats->p95 = percentile(sorted, count, 0.95);
+    out_stats->p99 = percentile(sorted, count, 0.99);
+    out_stats->max = sorted[count - 1];
+    return count;
+}
+
+u64 frame_stats_frame_count() {
+    return state.frame_count;
+}
+
+char* get_frame_stats_str() {
+    frame_phase_stats stats;
+    u32 count = frame_stats_get(FRAME_PHASE_FRAME, &stats);
+    u64 offset = snprintf(state.text, sizeof(state.text),
+                          "Frame timing (last %u frames, ms):\n"
+                          "  phase      avg      p50      p95      p99      max\n",
+                          count);
+    for (u32 i = 0; i < FRAME_PHASE_MAX; ++i) {
+        frame_stats_get((frame_phase)i, &stats);
+        offset += snprintf(state.text + offset, sizeof(state.text) - offset,
+                           "  %s: %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+                           phase_strings[i],
+                           stats.average * 1000.0, stats.p50 * 1000.0, stats.p95 * 1000.0,
+                           stats.p99 * 1000.0, stats.max * 1000.0);
+    }
+    return state.text;
+}
@@ -0,0 +1,89 @@
+/*
+  Хронометраж кадра по фазам.
+
+  Игровой цикл отмечает конец каждой фазы кадра (сообщения ОС, события,
+  update, render, ввод, ожидание темпа). Длительности последних
+  FRAME_STATS_HISTORY кадров хранятся в кольцевом буфере; по запросу
+  считаются среднее, p50/p95/p99 и максимум.
+
+  Отметка фазы - одно чтение часов и одно сложение, поэтому хронометраж
+  включён всегда, в том числе в релизе.
+*/
+#pragma once
+
+#include "defines.h"
+
+// Сколько последних кадров хранится (степень двойки)
+#define FRAME_STATS_HISTORY 256
+
+// Фазы кадра в порядке выполнения
+typedef enum frame_phase {
+    FRAME_PHASE_PUMP,    // сообщения ОС, воспроизведение ввода, сброс кадровой арены
+    FRAME_PHASE_EVENTS,  // рассылка событий кадра
+    FRAME_PHASE_UPDATE,  // update игры (все шаги симуляции кадра)
+    FRAME_PHASE_RENDER,  // render игры
+    FRAME_PHASE_INPUT,   // завершение кадра ввода
+    FRAME_PHASE_WAIT,    // ожидание начала следующего кадра (темп)
+    FRAME_PHASE_FRAME,   // весь кадр, от начала до начала следующего
+    FRAME_PHASE_MAX
+} frame_phase;
+
+/*
+ * Статистика фазы по хранимым кадрам, в секундах.
+ */
+typedef struct frame_phase_stats {
+    f64 average;
+    f64 p50;
+    f64 p95;
+    f64 p99;
+    f64 max;
+} frame_phase_stats;
+
+/*
+ * Начало кадра. Вызывается игровым циклом первым делом в кадре.
+ */
+void frame_stats_begin_frame();
+
+/*
+ * Конец фазы phase: время с предыдущей отметки (или начала кадра)
+ * добавляется к фазе. Фазу можно отмечать несколько раз за кадр.
+ */
+void frame_stats_mark(frame_phase phase);
+
+/*
+ * Конец кадра: длительности фаз кадра уходят в кольцевой буфер.
+ */
+void frame_stats_end_frame();
+
+/*
+ * Статистика фазы phase по последним кадрам.
+ *
+ * Параметры:
+ *   phase     - фаза (FRAME_PHASE_FRAME - кадр целиком)
+ *   out_stats - заполняемая статистика (нули, если кадров ещё не было)
+ *
+ * Возвращает:
+ *   Количество кадров, по которым посчитана статистика
+ *   (не больше FRAME_STATS_HISTORY)
+ */
+KAPI u32 frame_stats_get(frame_phase phase, frame_phase_stats* out_stats);
+
+/*
+ * Всего завершённых кадров с начала работы.
+ */
+KAPI u64 frame_stats_frame_count();
+
+/*
+ * Форматирует таблицу статистики всех фаз в миллисекундах.
+ *
+ * Пример вывода:
+ *   Frame timing (last 256 frames, ms):
+ *     phase      avg      p50      p95      p99      max
+ *     PUMP  :   0.004    0.003    0.008    0.012    0.020
+ *     ...
+ *
+ * Возвращает:
+ *   Строку во внутреннем буфере модуля: действительна до следующего
+ *   вызова, освобождать не нужно
+ */
+KAPI char* get_frame_stats_str();
@@ -0,0 +1,564 @@
+#include "core/input.h"
+#include "core/event.h"
+#include "core/kmemory.h"
+#include "core/logger.h"
+#include "platform/filesystem.h"
+
+// Сигнатура файла записи ввода ("KINP") и версия формата
+#define INPUT_RECORD_MAGIC 0x504E494B
+#define INPUT_RECORD_VERSION 1
+
+// Сколько записей копится в памяти перед записью в файл
+#define INPUT_RECORD_BUFFER_COUNT 4096
+
+/*
+ * Заголовок файла записи ввода.
+ */
+typedef struct input_record_header {
+    u32 magic;        // INPUT_RECORD_MAGIC
+    u16 version;      // INPUT_RECORD_VERSION
+    u16 record_size;  // sizeof(input_record)
+    f64 timestep;     // фиксированный шаг кадра записи, секунды
+} input_record_header;
+
+// Типы записей
+typedef enum input_record_type {
+    INPUT_RECORD_KEY = 1,     // code - клавиша, x - нажата
+    INPUT_RECORD_BUTTON,      // code - кнопка, x - нажата
+    INPUT_RECORD_MOUSE_MOVE,  // x, y - позиция
+    INPUT_RECORD_MOUSE_WHEEL, // x - приращение
+    INPUT_RECORD_SKIP,        // пропуск кадров без ввода (frame_delta не хватило)
+    INPUT_RECORD_END          // конец записи
+} input_record_type;
+
+/*
+ * Одна запись ввода - 8 байт.
+ * Кадр хранится как приращение к кадру предыдущей записи.
+ */
+typedef struct input_record {
+    u16 frame_delta;
+    u8 type;
+    u8 code;
+    i16 x;
+    i16 y;
+} input_record;
+
+STATIC_ASSERT(sizeof(input_record) == 8, "input_record must be 8 bytes.");
+STATIC_ASSERT(sizeof(input_record_header) == 16, "input_record_header must be 16 bytes.");
+
+// Состояние записи ввода в файл
+typedef struct input_recorder {
+    file_handle file;
+    input_record* buffer;  // INPUT_RECORD_BUFFER_COUNT записей
+    u32 buffered;
+    u64 last_frame;        // кадр последней записи
+    u64 record_count;
+} input_recorder;
+
+// Состояние воспроизведения записи
+typedef struct input_player {
+    input_record* records;  // весь файл в памяти
+    u64 record_count;
+    u64 records_size;       // размер блока records в байтах
+    u64 cursor;             // следующая запись
+    u64 next_frame;         // абсолютный кадр записи под курсором
+    b8 finished;
+} input_player;
+
+// Состояние кнопок мыши - тоже битовая маска
+typedef struct mouse_state {
+    i16 x;
+    i16 y;
+    u8 buttons;  // бит button установлен - кнопка нажата
+} mouse_state;
+
+typedef struct input_state {
+    input_key_bits keyboard_current;
+    input_key_bits keyboard_previous;
+    mouse_state mouse_current;
+    mouse_state mouse_previous;
+
+    // Номер кадра ввода (растёт в input_update)
+    u64 frame;
+
+    b8 recording;
+    b8 playing;
+    input_recorder recorder;
+    input_player player;
+} input_state;
+
+STATIC_ASSERT(BUTTON_MAX_BUTTONS <= 8, "mouse_state.buttons must fit all buttons.");
+
+// Внутреннее состояние системы ввода
+static b8 initialized = FALSE;
+static input_state state;
+
+//проверка бита клавиши в маске
+static inline b8 key_bit_get(const input_key_bits* bits, u32 key) {
+    return (bits->words[key >> 6] >> (key & 63)) & 1;
+}
+
+//отправка события клавиши. События ввода не вызывают слушателей сразу, а
+//встают в очередь: движок рассылает их пачкой в event_dispatch_queued,
+//перемещения мыши за кадр сливаются в одно
+static void input_fire_key(u16 code, u32 key) {
+    event_context context;
+    context.data.u16[0] = (u16)key;
+    event_post(code, 0, context);
+}
+
+void input_initialize() {
+    kzero_memory(&state, sizeof(input_state));
+    initialized = TRUE;
+    KINFO("Input subsystem initialized.");
+}
+
+void input_shutdown() {
+    // Дописываем и закрываем незавершённую запись
+    input_recording_end();
+    input_playback_end();
+    initialized = FALSE;
+}
+
+void input_update(f64 delta_time) {
+    if (!initialized) {
+        return;
+    }
+
+    // Копируем текущие состояния в предыдущие
+    state.keyboard_previous = state.keyboard_current;
+    state.mouse_previous = state.mouse_current;
+    state.frame++;
+}
+
+/* - клавиатура - */
+
+/*
+ * Добавляет запись в буфер записи ввода (если запись идёт).
+ */
+static void input_record_push(u8 type, u8 code, i16 x, i16 y);
+
+/*
+ * Применяет изменение клавиши. Общая часть для платформы, внедрения
+ * и воспроизведения записи.
+ */
+static void input_apply_key(keys key, b8 pressed) {
+    // Меняем и отправляем событие, только если состояние изменилось
+    u64* word = &state.keyboard_current.words[key >> 6];
+    u64 mask = 1ULL << (key & 63);
+    if (((*word & mask) != 0) == (pressed != 0)) {
+        return;
+    }
+    *word ^= mask;
+    input_record_push(INPUT_RECORD_KEY, (u8)key, pressed ? 1 : 0, 0);
+    input_fire_key(pressed ? EVENT_CODE_KEY_PRESSED : EVENT_CODE_KEY_RELEASED, key);
+}
+
+void input_process_key(keys key, b8 pressed) {
+    // Во время воспроизведения живой ввод игнорируется - иначе нет детерминизма
+    if (!initialized || state.playing || (u32)key >= KEYS_MAX_KEYS) {
+        return;
+    }
+    input_apply_key(key, pressed);
+}
+
+void input_process_key_bits(const input_key_bits* bits) {
+    if (!initialized || state.playing || !bits) {
+        return;
+    }
+
+    // Разница по словам: пустые слова пропускаются целиком
+    input_key_bits released;
+    input_key_bits pressed;
+    for (u32 w = 0; w < INPUT_KEY_WORDS; ++w) {
+        u64 changed = state.keyboard_current.words[w] ^ bits->words[w];
+        released.words[w] = changed & state.keyboard_current.words[w];
+        pressed.words[w] = changed & bits->words[w];
+    }
+    state.keyboard_current = *bits;
+
+    // Обходим только установленные биты
+    for (u32 w = 0; w < INPUT_KEY_WORDS; ++w) {
+        for (u64 m = released.words[w]; m; m &= m - 1) {
+            u32 key = (w << 6) + (u32)__builtin_ctzll(m);
+            input_record_push(INPUT_RECORD_KEY, (u8)key, 0, 0);
+            input_fire_key(EVENT_CODE_KEY_RELEASED, key);
+        }
+    }
+    for (u32 w = 0; w < INPUT_KEY_WORDS; ++w) {
+        for (u64 m = pressed.words[w]; m; m &= m - 1) {
+            u32 key = (w << 6) + (u32)__builtin_ctzll(m);
+            input_record_push(INPUT_RECORD_KEY, (u8)key, 1, 0);
+            input_fire_key(EVENT_CODE_KEY_PRESSED, key);
+        }
+    }
+}
+
+b8 input_is_key_down(keys key) {
+    if (!initialized || (u32)key >= KEYS_MAX_KEYS) {
+        return FALSE;
+    }
+    return key_bit_get(&state.keyboard_current, key);
+}
+
+b8 input_is_key_up(keys key) {
+    if (!initialized || (u32)key >= KEYS_MAX_KEYS) {
+        return TRUE;
+    }
+    return !key_bit_get(&state.keyboard_current, key);
+}
+
+b8 input_was_key_down(keys key) {
+    if (!initialized || (u32)key >= KEYS_MAX_KEYS) {
+        return FALSE;
+    }
+    return key_bit_get(&state.keyboard_previous, key);
+}
+
+b8 input_was_key_up(keys key) {
+    if (!initialized || (u32)key >= KEYS_MAX_KEYS) {
+        return TRUE;
+    }
+    return !key_bit_get(&state.keyboard_previous, key);
+}
+
+void input_get_key_bits(b8 previous, input_key_bits* out_bits) {
+    if (!out_bits) {
+        return;
+    }
+    *out_bits = previous ? state.keyboard_previous : state.keyboard_current;
+}
+
+b8 input_any_key_changed() {
+    u64 changed = 0;
+    for (u32 w = 0; w < INPUT_KEY_WORDS; ++w) {
+        changed |= state.keyboard_current.words[w] ^ state.keyboard_previous.words[w];
+    }
+    return changed != 0;
+}
+
+/* - мышь - */
+
+b8 input_is_button_down(buttons button) {
+    if (!initialized || (u32)button >= BUTTON_MAX_BUTTONS) {
+        return FALSE;
+    }
+    return (state.mouse_current.buttons >> button) & 1;
+}
+
+b8 input_is_button_up(buttons button) {
+    if (!initialized || (u32)button >= BUTTON_MAX_BUTTONS) {
+        return TRUE;
+    }
+    return !((state.mouse_current.buttons >> button) & 1);
+}
+
+b8 input_was_button_down(buttons button) {
+    if (!initialized || (u32)button >= BUTTON_MAX_BUTTONS) {
+        return FALSE;
+    }
+    return (state.mouse_previous.buttons >> button) & 1;
+}
+
+b8 input_was_button_up(buttons button) {
+    if (!initialized || (u32)button >= BUTTON_MAX_BUTTONS) {
+        return TRUE;
+    }
+    return !((state.mouse_previous.buttons >> button) & 1);
+}
+
+void input_get_mouse_position(i32* x, i32* y) {
+    if (!initialized) {
+        *x = 0;
+        *y = 0;
+        return;
+    }
+    *x = state.mouse_current.x;
+    *y = state.mouse_current.y;
+}
+
+void input_get_previous_mouse_position(i32* x, i32* y) {
+    if (!initialized) {
+        *x = 0;
+        *y = 0;
+        return;
+    }
+    *x = state.mouse_previous.x;
+    *y = state.mouse_previous.y;
+}
+
+static void input_apply_button(buttons button, b8 pressed) {
+    u8 mask = (u8)(1 << button);
+    if (((state.mouse_current.buttons & mask) != 0) == (pressed != 0)) {
+        return;
+    }
+    state.mouse_current.buttons ^= mask;
+    input_record_push(INPUT_RECORD_BUTTON, (u8)button, pressed ? 1 : 0, 0);
+
+    event_context context;
+    context.data.u16[0] = button;
+    event_post(pressed ? EVENT_CODE_BUTTON_PRESSED : EVENT_CODE_BUTTON_RELEASED, 0, context);
+}
+
+void input_process_button(buttons button, b8 pressed) {
+    if (!initialized || state.playing || (u32)button >= BUTTON_MAX_BUTTONS) {
+        return;
+    }
+    input_apply_button(button, pressed);
+}
+
+static void input_apply_mouse_move(i16 x, i16 y) {
+    // Событие только при реальном перемещении
+    if (state.mouse_current.x == x && state.mouse_current.y == y) {
+        return;
+    }
+    state.mouse_current.x = x;
+    state.mouse_current.y = y;
+    input_record_push(INPUT_RECORD_MOUSE_MOVE, 0, x, y);
+
+    event_context context;
+    context.data.u16[0] = x;
+    context.data.u16[1] = y;
+    event_post(EVENT_CODE_MOUSE_MOVED, 0, context);
+}
+
+void input_process_mouse_move(i16 x, i16 y) {
+    if (!initialized || state.playing) {
+        return;
+    }
+    input_apply_mouse_move(x, y);
+}
+
+static void input_apply_mouse_wheel(i8 z_delta) {
+    // Состояния у колеса нет, только приращение, сведённое к -1/1
+    i8 direction = z_delta < 0 ? -1 : 1;
+    input_record_push(INPUT_RECORD_MOUSE_WHEEL, 0, direction, 0);
+
+    event_context context;
+    context.data.u8[0] = (u8)direction;
+    event_post(EVENT_CODE_MOUSE_WHEEL, 0, context);
+}
+
+void input_process_mouse_wheel(i8 z_delta) {
+    if (!initialized || state.playing || z_delta == 0) {
+        return;
+    }
+    input_apply_mouse_wheel(z_delta);
+}
+
+/* - запись и воспроизведение - */
+
+//записывает накопленные записи в файл
+static void input_record_flush() {
+    input_recorder* recorder = &state.recorder;
+    if (recorder->buffered == 0) {
+        return;
+    }
+    u64 size = sizeof(input_record) * recorder->buffered;
+    u64 written = 0;
+    if (!filesystem_write(&recorder->file, size, recorder->buffer, &written)) {
+        KERROR("input_record - failed to write %llu bytes of input records.", size);
+    }
+    recorder->buffered = 0;
+}
+
+//добавляет одну запись, без учёта кадра
+static void input_record_append(input_record record) {
+    input_recorder* recorder = &state.recorder;
+    recorder->buffer[recorder->buffered++] = record;
+    recorder->record_count++;
+    if (recorder->buffered == INPUT_RECORD_BUFFER_COUNT) {
+        input_record_flush();
+    }
+}
+
+static void input_record_push(u8 type, u8 code, i16 x, i16 y) {
+    if (!state.recording) {
+        return;
+    }
+    input_recorder* recorder = &state.recorder;
+
+    // Длинные паузы без ввода разбиваем на записи пропуска
+    u64 delta = state.frame - recorder->last_frame;
+    while (delta > 0xFFFF) {
+        input_record skip = {0xFFFF, INPUT_RECORD_SKIP, 0, 0, 0};
+        input_record_append(skip);
+        delta -= 0xFFFF;
+    }
+    recorder->last_frame = state.frame;
+
+    input_record record = {(u16)delta, type, code, x, y};
+    input_record_append(record);
+}
+
+b8 input_recording_begin(const char* path, f64 timestep) {
+    if (!initialized || state.recording || state.playing) {
+        KERROR("input_recording_begin - input is not initialized or already recording/playing.");
+        return FALSE;
+    }
+    input_recorder* recorder = &state.recorder;
+    if (!filesystem_open(path, FILE_MODE_WRITE, TRUE, &recorder->file)) {
+        return FALSE;
+    }
+
+    input_record_header header;
+    kzero_memory(&header, sizeof(header));
+    header.magic = INPUT_RECORD_MAGIC;
+    header.version = INPUT_RECORD_VERSION;
+    header.record_size = sizeof(input_record);
+    header.timestep = timestep;
+    u64 written = 0;
+    if (!filesystem_write(&recorder->file, sizeof(header), &header, &written)) {
+        KERROR("input_recording_begin - failed to write header to '%s'.", path);
+        filesystem_close(&recorder->file);
+        return FALSE;
+    }
+
+    recorder->buffer = kallocate_ex(sizeof(input_record) * INPUT_RECORD_BUFFER_COUNT, 0, MEMORY_TAG_ARRAY, KALLOCATE_FLAG_NO_ZERO);
+    recorder->buffered = 0;
+    recorder->record_count = 0;
+    recorder->last_frame = state.frame;
+    state.recording = TRUE;
+    KINFO("Recording input to '%s' (timestep %.4f s).", path, timestep);
+    return TRUE;
+}
+
+void input_recording_end() {
+    if (!state.recording) {
+        return;
+    }
+    // Запись конца фиксирует длину сессии в кадрах
+    input_record_push(INPUT_RECORD_END, 0, 0, 0);
+    state.recording = FALSE;
+
+    input_recorder* recorder = &state.recorder;
+    input_record_flush();
+    filesystem_close(&recorder->file);
+    kfree(recorder->buffer, sizeof(input_record) * INPUT_RECORD_BUFFER_COUNT, MEMORY_TAG_ARRAY);
+    recorder->buffer = 0;
+    KINFO("Input recording finished: %llu records, %llu frames.", recorder->record_count, state.frame);
+}
+
+//абсолютный кадр записи под курсором
+static void input_playback_seek_next() {
+    input_player* player = &state.player;
+    // Пропуски только сдвигают кадр
+    while (player->cursor < player->record_count && player->records[player->cursor].type == INPUT_RECORD_SKIP) {
+        player->next_frame += player->records[player->cursor].frame_delta;
+        player->cursor++;
+    }
+    if (player->cursor < player->record_count) {
+        player->next_frame += player->records[player->cursor].frame_delta;
+    }
+}
+
+b8 input_playback_begin(const char* path, f64* out_timestep) {
+    if (!initialized || state.recording || state.playing) {
+        KERROR("input_playback_begin - input is not initialized or already recording/playing.");
+        return FALSE;
+    }
+
+    file_handle file;
+    if (!filesystem_open(path, FILE_MODE_READ, TRUE, &file)) {
+        return FALSE;
+    }
+    input_record_header header;
+    u64 file_size = 0;
+    u64 read = 0;
+    if (!filesystem_size(&file, &file_size) || !filesystem_read(&file, sizeof(header), &header, &read) ||
+        header.magic != INPUT_RECORD_MAGIC || header.version != INPUT_RECORD_VERSION ||
+        header.record_size != sizeof(input_record)) {
+        KERROR("input_playback_begin - '%s' is not a valid input recording.", path);
+        filesystem_close(&file);
+        return FALSE;
+    }
+
+    // Весь файл сразу в память: воспроизведение не трогает диск
+    input_player* player = &state.player;
+    player->record_count = (file_size - sizeof(header)) / sizeof(input_record);
+    player->records_size = player->record_count * sizeof(input_record);
+    player->records = 0;
+    if (player->records_size > 0) {
+        player->records = kallocate_ex(player->records_size, 0, MEMORY_TAG_ARRAY, KALLOCATE_FLAG_NO_ZERO);
+        if (!filesystem_read(&file, player->records_size, player->records, &read)) {
+            KERROR("input_playback_begin - failed to read records from '%s'.", path);
+            kfree(player->records, player->records_size, MEMORY_TAG_ARRAY);
+            player->records = 0;
+            filesystem_close(&file);
+            return FALSE;
+        }
+    }
+    filesystem_close(&file);
+
+    player->cursor = 0;
+    player->next_frame = state.frame;
+    player->finished = FALSE;
+    input_playback_seek_next();
+    state.playing = TRUE;
+
+    if (out_timestep) {
+        *out_timestep = header.timestep;
+    }
+    KINFO("Replaying input from '%s': %llu records (timestep %.4f s).", path, player->record_count, header.timestep);
+    return TRUE;
+}
+
+void input_playback_frame() {
+    if (!state.playing) {
+        return;
+    }
+    input_player* player = &state.player;
+
+    // Применяем все записи текущего кадра
+    while (!player->finished && player->cursor < player->record_count && player->next_frame <= state.frame) {
+        input_record* record = &player->records[player->cursor];
+        switch (record->type) {
+            case INPUT_RECORD_KEY:
+                input_apply_key((keys)record->code, record->x != 0);
+                break;
+            case INPUT_RECORD_BUTTON:
+                if (record->code < BUTTON_MAX_BUTTONS) {
+                    input_apply_button((buttons)record->code, record->x != 0);
+                }
+                break;
+            case INPUT_RECORD_MOUSE_MOVE:
+                input_apply_mouse_move(record->x, record->y);
+                break;
+            case INPUT_RECORD_MOUSE_WHEEL:
+                input_apply_mouse_wheel((i8)record->x);
+                break;
+            case INPUT_RECORD_END:
+                player->finished = TRUE;
+                break;
+            default:
+                KWARN("input_playback_frame - unknown record type %u, skipped.", record->type);
+                break;
+        }
+        player->cursor++;
+        input_playback_seek_next();
+    }
+
+    // Файл оборвался без записи конца - считаем, что запись закончилась
+    if (player->cursor >= player->record_count) {
+        player->finished = TRUE;
+    }
+}
+
+b8 input_playback_finished() {
+    return !state.playing || state.player.finished;
+}
+
+void input_playback_end() {
+    if (!state.playing) {
+        return;
+    }
+    if (state.player.records) {
+        kfree(state.player.records, state.player.records_size, MEMORY_TAG_ARRAY);
+    }
+    kzero_memory(&state.player, sizeof(input_player));
+    state.playing = FALSE;
+}
+
+u64 input_get_frame() {
+    return state.frame;
+}
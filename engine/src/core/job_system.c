@@ -0,0 +1,330 @@
+#include "core/job_system.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+#include "core/profiler.h"
+#include "platform/atomic.h"
+#include "platform/platform.h"
+
+// Максимум потоков системы (главный + рабочие)
+#define JOB_SYSTEM_MAX_THREADS 128
+
+// Ёмкость дека одного потока (степень двойки). Если дек полон, задача
+// выполняется сразу в ставящем потоке
+#define JOB_DEQUE_CAPACITY 4096
+
+// Сколько раз рабочий поток безуспешно ищет задачи, прежде чем уснуть
+#define JOB_SPIN_ROUNDS 64
+
+// Сон рабочего потока без сигналов: страховка от потерянного пробуждения
+#define JOB_SLEEP_TIMEOUT_MS 10
+
+// Задача
+typedef struct job_record {
+    pfn_job_entry entry;
+    void* param;
+    job_counter* counter;
+} job_record;
+
+// Ячейка дека. Вор может читать её одновременно с записью владельца,
+// поэтому поля атомарные (relaxed); результат такого чтения отбрасывается
+// неудачным CAS
+typedef struct job_slot {
+    atomic_ptr entry;
+    atomic_ptr param;
+    atomic_ptr counter;
+} job_slot;
+
+/*
+ * Дек задач потока (Chase-Lev, фиксированной ёмкости).
+ * Владелец кладёт и берёт с конца (bottom), воры забирают с начала (top)
+ * через CAS. top и bottom - в разных кэш-линиях: их пишут разные потоки.
+ * Позиции только растут; сравниваются как знаковые, потому что bottom
+ * в job_deque_pop на время проверки может уйти на единицу ниже top.
+ */
+typedef struct job_deque {
+    atomic_u64 top;
+    u8 pad_top[PLATFORM_CACHE_LINE_SIZE - sizeof(atomic_u64)];
+    atomic_u64 bottom;
+    u8 pad_bottom[PLATFORM_CACHE_LINE_SIZE - sizeof(atomic_u64)];
+    job_slot* jobs;
+    u8 pad_jobs[PLATFORM_CACHE_LINE_SIZE - sizeof(job_slot*)];
+} job_deque;
+
+typedef struct job_system_state {
+    b8 initialized;
+    atomic_u32 running;
+    atomic_u32 thread_count;  // главный + запущенные рабочие
+    u32 deque_count;          // выделено деков (по запрошенному числу потоков)
+    job_deque* deques;        // по деку на поток, [0] - главный
+    platform_thread workers[JOB_SYSTEM_MAX_THREADS];
+    platform_semaphore wake;
+    atomic_u32 sleeping;      // рабочих потоков, спящих на семафоре
+} job_system_state;
+
+static job_system_state state;
+
+// Индекс потока в системе: 0 - главный, 1.. - рабочие, -1 - посторонний
+static KTHREAD_LOCAL i32 thread_index = -1;
+// Состояние генератора выбора жертвы для кражи
+static KTHREAD_LOCAL u32 steal_seed = 0;
+
+static void job_slot_store(job_slot* slot, const job_record* job) {
+    atomic_store_ptr(&slot->entry, (void*)job->entry, ATOMIC_ORDER_RELAXED);
+    atomic_store_ptr(&slot->param, job->param, ATOMIC_ORDER_RELAXED);
+    atomic_store_ptr(&slot->counter, job->counter, ATOMIC_ORDER_RELAXED);
+}
+
+static void job_slot_load(job_slot* slot, job_record* out_job) {
+    out_job->entry = (pfn_job_entry)atomic_load_ptr(&slot->entry, ATOMIC_ORDER_RELAXED);
+    out_job->param = atomic_load_ptr(&slot->param, ATOMIC_ORDER_RELAXED);
+    out_job->counter = atomic_load_ptr(&slot->counter, ATOMIC_ORDER_RELAXED);
+}
+
+//кладёт задачу в конец своего дека; FALSE - дек полон
+static b8 job_deque_push(job_deque* deque, const job_record* job) {
+    i64 bottom = (i64)atomic_load_u64(&deque->bottom, ATOMIC_ORDER_RELAXED);
+    i64 top = (i64)atomic_load_u64(&deque->top, ATOMIC_ORDER_ACQUIRE);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) {
+        return FALSE;
+    }
+    job_slot_store(&deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)], job);
+    atomic_store_u64(&deque->bottom, (u64)(bottom + 1), ATOMIC_ORDER_RELEASE);
+    return TRUE;
+}
+
+//берёт задачу с конца своего дека
+static b8 job_deque_pop(job_deque* deque, job_record* out_job) {
+    i64 bottom = (i64)atomic_load_u64(&deque->bottom, ATOMIC_ORDER_RELAXED) - 1;
+    atomic_store_u64(&deque->bottom, (u64)bottom, ATOMIC_ORDER_RELAXED);
+    atomic_fence(ATOMIC_ORDER_SEQ_CST);
+    i64 top = (i64)atomic_load_u64(&deque->top, ATOMIC_ORDER_RELAXED);
+
+    if (top > bottom) {
+        // Пусто
+        atomic_store_u64(&deque->bottom, (u64)(bottom + 1), ATOMIC_ORDER_RELAXED);
+        return FALSE;
+    }
+    job_slot_load(&deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)], out_job);
+    if (top == bottom) {
+        // Последняя задача: соревнуемся с ворами за неё
+        u64 expected = (u64)top;
+        b8 won = atomic_compare_exchange_u64(&deque->top, &expected, (u64)(top + 1),
+                                             ATOMIC_ORDER_SEQ_CST, ATOMIC_ORDER_RELAXED);
+        atomic_store_u64(&deque->bottom, (u64)(bottom + 1), ATOMIC_ORDER_RELAXED);
+        return won;
+    }
+    return TRUE;
+}
+
+//забирает задачу с начала чужого дека
+static b8 job_deque_steal(job_deque* deque, job_record* out_job) {
+    i64 top = (i64)atomic_load_u64(&deque->top, ATOMIC_ORDER_ACQUIRE);
+    atomic_fence(ATOMIC_ORDER_SEQ_CST);
+    i64 bottom = (i64)atomic_load_u64(&deque->bottom, ATOMIC_ORDER_ACQUIRE);
+    if (top >= bottom) {
+        return FALSE;
+    }
+    job_slot_load(&deque->jobs[top & (JOB_DEQUE_CAPACITY - 1)], out_job);
+    u64 expected = (u64)top;
+    return atomic_compare_exchange_u64(&deque->top, &expected, (u64)(top + 1),
+                                       ATOMIC_ORDER_SEQ_CST, ATOMIC_ORDER_RELAXED);
+}
+
+static void job_execute(const job_record* job) {
+    KPROFILE_BEGIN("job");
+    job->entry(job->param);
+    KPROFILE_END("job");
+    if (job->counter) {
+        atomic_fetch_sub_u32(&job->counter->value, 1, ATOMIC_ORDER_RELEASE);
+    }
+}
+
+//xorshift32: выбор первой жертвы, чтобы воры не толпились у одного дека
+static u32 job_next_random() {
+    u32 x = steal_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    steal_seed = x;
+    return x;
+}
+
+//выполняет одну задачу: свою или украденную. FALSE - задач нигде нет
+static b8 job_try_run(u32 index) {
+    job_record job;
+    if (job_deque_pop(&state.deques[index], &job)) {
+        job_execute(&job);
+        return TRUE;
+    }
+    u32 count = atomic_load_u32(&state.thread_count, ATOMIC_ORDER_ACQUIRE);
+    if (count < 2) {
+        return FALSE;
+    }
+    u32 start = job_next_random() % count;
+    for (u32 i = 0; i < count; ++i) {
+        u32 victim = (start + i) % count;
+        if (victim != index && job_deque_steal(&state.deques[victim], &job)) {
+            job_execute(&job);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+//есть ли задачи хоть в одном деке
+static b8 job_any_pending() {
+    u32 count = atomic_load_u32(&state.thread_count, ATOMIC_ORDER_ACQUIRE);
+    for (u32 i = 0; i < count; ++i) {
+        job_deque* deque = &state.deques[i];
+        if ((i64)atomic_load_u64(&deque->top, ATOMIC_ORDER_SEQ_CST) <
+            (i64)atomic_load_u64(&deque->bottom, ATOMIC_ORDER_SEQ_CST)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// Рабочий поток
+static u32 job_worker_thread(void* params) {
+    thread_index = (i32)(u64)params;
+    steal_seed = 0x9E3779B9u * (u32)(thread_index + 1);
+    profiler_set_thread_name("job worker");
+
+    u32 idle_rounds = 0;
+    while (atomic_load_u32(&state.running, ATOMIC_ORDER_ACQUIRE)) {
+        if (job_try_run((u32)thread_index)) {
+            idle_rounds = 0;
+            continue;
+        }
+        if (++idle_rounds < JOB_SPIN_ROUNDS) {
+            platform_thread_yield();
+            continue;
+        }
+
+        // Объявляем, что засыпаем, и проверяем деки ещё раз: задачу могли
+        // поставить до того, как ставящий увидел счётчик спящих
+        atomic_fetch_add_u32(&state.sleeping, 1, ATOMIC_ORDER_SEQ_CST);
+        if (!job_any_pending() && atomic_load_u32(&state.running, ATOMIC_ORDER_ACQUIRE)) {
+            platform_semaphore_wait(&state.wake, JOB_SLEEP_TIMEOUT_MS);
+        }
+        atomic_fetch_sub_u32(&state.sleeping, 1, ATOMIC_ORDER_SEQ_CST);
+        idle_rounds = 0;
+    }
+    return 0;
+}
+
+b8 job_system_initialize(u32 worker_count) {
+    if (state.initialized) {
+        KWARN("job_system_initialize called more than once.");
+        return TRUE;
+    }
+    if (worker_count == 0) {
+        worker_count = platform_get_processor_count() - 1;
+    }
+    if (worker_count > JOB_SYSTEM_MAX_THREADS - 1) {
+        worker_count = JOB_SYSTEM_MAX_THREADS - 1;
+    }
+
+    if (!platform_semaphore_create(0, &state.wake)) {
+        return FALSE;
+    }
+    u32 thread_count = worker_count + 1;
+    state.deques = kallocate_ex(sizeof(job_deque) * thread_count, PLATFORM_CACHE_LINE_SIZE, MEMORY_TAG_JOB, KALLOCATE_FLAG_NONE);
+    for (u32 i = 0; i < thread_count; ++i) {
+        state.deques[i].jobs = kallocate_ex(sizeof(job_slot) * JOB_DEQUE_CAPACITY, 0, MEMORY_TAG_JOB, KALLOCATE_FLAG_NO_ZERO);
+    }
+    state.deque_count = thread_count;
+    atomic_store_u32(&state.thread_count, 1, ATOMIC_ORDER_RELAXED);
+    atomic_store_u32(&state.sleeping, 0, ATOMIC_ORDER_RELAXED);
+    atomic_store_u32(&state.running, TRUE, ATOMIC_ORDER_RELEASE);
+
+    // Вызывающий поток - главный
+    thread_index = 0;
+    steal_seed = 0x9E3779B9u;
+
+    // Потоки добавляются по одному: если ОС отказала, работаем с теми, что есть
+    for (u32 i = 1; i < thread_count; ++i) {
+        if (!platform_thread_create(job_worker_thread, (void*)(u64)i, &state.workers[i])) {
+            KWARN("job_system_initialize - only %u of %u worker threads started.", i - 1, worker_count);
+            break;
+        }
+        atomic_store_u32(&state.thread_count, i + 1, ATOMIC_ORDER_RELEASE);
+    }
+    state.initialized = TRUE;
+    KINFO("Job system initialized with %u worker thread(s).", job_system_worker_count());
+    return TRUE;
+}
+
+void job_system_shutdown() {
+    if (!state.initialized) {
+        return;
+    }
+    atomic_store_u32(&state.running, FALSE, ATOMIC_ORDER_RELEASE);
+    u32 thread_count = atomic_load_u32(&state.thread_count, ATOMIC_ORDER_ACQUIRE);
+    for (u32 i = 1; i < thread_count; ++i) {
+        platform_semaphore_signal(&state.wake);
+    }
+    for (u32 i = 1; i < thread_count; ++i) {
+        platform_thread_join(&state.workers[i]);
+    }
+
+    for (u32 i = 0; i < state.deque_count; ++i) {
+        kfree(state.deques[i].jobs, sizeof(job_slot) * JOB_DEQUE_CAPACITY, MEMORY_TAG_JOB);
+    }
+    kfree_ex(state.deques, sizeof(job_deque) * state.deque_count, PLATFORM_CACHE_LINE_SIZE, MEMORY_TAG_JOB);
+    platform_semaphore_destroy(&state.wake);
+    state.deques = 0;
+    state.initialized = FALSE;
+    thread_index = -1;
+}
+
+u32 job_system_worker_count() {
+    return state.initialized ? atomic_load_u32(&state.thread_count, ATOMIC_ORDER_ACQUIRE) - 1 : 0;
+}
+
+void job_system_submit(const job_desc* jobs, u32 count, job_counter* counter) {
+    if (count == 0) {
+        return;
+    }
+    if (counter) {
+        atomic_fetch_add_u32(&counter->value, count, ATOMIC_ORDER_RELAXED);
+    }
+
+    i32 index = thread_index;
+    for (u32 i = 0; i < count; ++i) {
+        job_record job;
+        job.entry = jobs[i].entry;
+        job.param = jobs[i].param;
+        job.counter = counter;
+        // Посторонний поток или полный дек - выполняем сразу
+        if (index < 0 || !job_deque_push(&state.deques[index], &job)) {
+            job_execute(&job);
+        }
+    }
+
+    // Будим спящих, не больше, чем поставлено задач
+    if (index >= 0) {
+        atomic_fence(ATOMIC_ORDER_SEQ_CST);
+        u32 sleeping = atomic_load_u32(&state.sleeping, ATOMIC_ORDER_SEQ_CST);
+        u32 wake = sleeping < count ? sleeping : count;
+        for (u32 i = 0; i < wake; ++i) {
+            platform_semaphore_signal(&state.wake);
+        }
+    }
+}
+
+void job_system_wait(job_counter* counter) {
+    i32 index = thread_index;
+    while (atomic_load_u32(&counter->value, ATOMIC_ORDER_ACQUIRE) > 0) {
+        // Вместо блокировки помогаем выполнять задачи
+        if (index >= 0 && job_try_run((u32)index)) {
+            continue;
+        }
+        platform_thread_yield();
+    }
+}
+
+b8 job_counter_is_done(const job_counter* counter) {
+    return atomic_load_u32(&counter->value, ATOMIC_ORDER_ACQUIRE) == 0;
+}
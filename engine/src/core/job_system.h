@@ -0,0 +1,90 @@
+/*
+  Система задач (job system).
+
+  Задача - функция с параметром. Рабочих потоков по одному на ядро
+  (главный поток - ещё одно). У каждого потока своя очередь задач
+  (дек): свои задачи поток берёт с конца, свободные потоки крадут
+  чужие с начала. Поэтому горячая работа остаётся в кэше своего ядра,
+  а нагрузка сама расходится по свободным.
+
+  Завершение отслеживается счётчиками: job_system_submit прибавляет к
+  счётчику число задач, каждая выполненная задача вычитает единицу.
+  job_system_wait ждёт обнуления счётчика и, пока ждёт, сам выполняет
+  задачи. Зависимость выражается так же: задача, которой нужны
+  результаты других, ставит их со своим счётчиком и ждёт его - поток
+  при этом не простаивает.
+*/
+#pragma once
+
+#include "defines.h"
+#include "platform/atomic.h"
+
+// Функция задачи
+typedef void (*pfn_job_entry)(void* param);
+
+/*
+ * Описание задачи.
+ */
+typedef struct job_desc {
+    pfn_job_entry entry;
+    void* param;
+} job_desc;
+
+/*
+ * Счётчик незавершённых задач. Перед первой постановкой - ноль
+ * (достаточно обнулённой структуры), после job_system_wait - снова ноль,
+ * счётчик можно использовать повторно.
+ */
+typedef struct job_counter {
+    atomic_u32 value;
+} job_counter;
+
+/*
+ * Запускает рабочие потоки. Вызывающий поток считается главным: он может
+ * ставить задачи и помогать их выполнять.
+ *
+ * Параметры:
+ *   worker_count - количество рабочих потоков; 0 - по числу логических
+ *                  процессоров минус один (на главный поток)
+ *
+ * Возвращает:
+ *   TRUE - система запущена (возможно, без рабочих потоков: тогда задачи
+ *   выполняет главный поток в job_system_wait)
+ */
+KAPI b8 job_system_initialize(u32 worker_count);
+
+/*
+ * Останавливает рабочие потоки. Поставленные задачи к этому моменту
+ * должны быть завершены (дождитесь их через job_system_wait).
+ */
+KAPI void job_system_shutdown();
+
+/*
+ * Количество рабочих потоков (без главного).
+ */
+KAPI u32 job_system_worker_count();
+
+/*
+ * Ставит count задач в очередь вызывающего потока.
+ *
+ * Параметры:
+ *   jobs    - описания задач (копируются)
+ *   count   - количество
+ *   counter - счётчик завершения (0 - не отслеживать)
+ *
+ * Ставить задачи могут главный поток и сами задачи. Из других потоков
+ * (и до job_system_initialize) задачи выполняются сразу, в вызывающем
+ * потоке.
+ */
+KAPI void job_system_submit(const job_desc* jobs, u32 count, job_counter* counter);
+
+/*
+ * Ждёт, пока счётчик не обнулится, выполняя тем временем задачи
+ * (свои и украденные у других потоков).
+ */
+KAPI void job_system_wait(job_counter* counter);
+
+/*
+ * TRUE, если все задачи счётчика завершены (не ждёт).
+ */
+KAPI b8 job_counter_is_done(const job_counter* counter);
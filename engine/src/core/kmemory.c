@@ -1,19 +1,52 @@
 #include "kmemory.h"
 #include "core/logger.h"
+#include "core/asserts.h"
+#include "core/profiler.h"
 #include "platform/platform.h"
+#include "platform/atomic.h"
 
 // TODO: Custom string lib - в будущем заменить на свою реализацию строк
 #include <string.h>
 #include <stdio.h>
 
+// _strdup есть только в CRT от Microsoft, в POSIX это strdup
+#if !defined(KPLATFORM_WINDOWS)
+#define _strdup strdup
+#endif
+
+// Выравнивание, которое системный malloc гарантирует и так.
+// Всё, что больше, идёт через platform_allocate_aligned.
+#define KMEMORY_MALLOC_ALIGNMENT 16
+
 /*
- * Структура для хранения статистики использования памяти.
+ * Заголовок перед каждым блоком kallocate. По нему kfree выбирает, каким
+ * системным вызовом освобождать блок, - выравнивание не нужно помнить
+ * вызывающему. Размер заголовка - KMEMORY_MALLOC_ALIGNMENT, поэтому
+ * обычный блок остаётся выровненным, как у malloc.
  */
-struct memory_stats {
-    u64 total_allocated;  //общий объём выделенной памяти в байтах 
-    u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];  //массив с объёмами памяти по каждому тегу 
-};
+typedef struct kmemory_header {
+    u64 alignment;  // 0 - обычный блок (malloc), иначе выравнивание блока
+    u64 offset;     // от начала системного блока до блока пользователя
+} kmemory_header;
 
+static kmemory_header* kmemory_get_header(void* block) {
+    return (kmemory_header*)block - 1;
+}
+
+/*
+ * Статистика использования памяти одного потока.
+ * 
+ * Каждый поток пишет только в свой блок, поэтому kallocate/kfree не берут
+ * блокировок и не делают атомарных read-modify-write операций.
+ * Счётчики знаковые: память, выделенная в одном потоке и освобождённая
+ * в другом, даёт плюс в одном блоке и минус в другом, а сумма остаётся верной.
+ * Суммирование по всем потокам делается по запросу в get_memory_usage_str().
+ */
+typedef struct memory_stats {
+    atomic_u64 total_allocated;  //общий объём выделенной памяти в байтах 
+    atomic_u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];  //массив с объёмами памяти по каждому тегу 
+    struct memory_stats* next;  //следующий блок в глобальном списке потоков
+} memory_stats;
 
 /*
  * Массив строковых представлений для каждого тега памяти.
@@ -37,22 +70,73 @@ static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "TRANSFORM  ",  // MEMORY_TAG_TRANSFORM
     "ENTITY     ",  // MEMORY_TAG_ENTITY
     "ENTITY_NODE",  // MEMORY_TAG_ENTITY_NODE
-    "SCENE      "   // MEMORY_TAG_SCENE
+    "SCENE      ",  // MEMORY_TAG_SCENE
+    "LINEAR_ALLC",  // MEMORY_TAG_LINEAR_ALLOCATOR (сокращённо)
+    "FRAME      "   // MEMORY_TAG_FRAME
 };
 
 /*
- * Глобальная переменная со статистикой памяти.
- * static - видна только в этом файле.
+ * Глобальный список блоков статистики всех потоков.
+ * Блок добавляется при первом выделении памяти в потоке (lock-free вставка
+ * в голову списка) и живёт до конца процесса: поток может завершиться,
+ * а память, выделенная им, - остаться в использовании.
+ */
+static atomic_ptr stats_head = {0};
+
+/*
+ * Пиковое заполнение по тегам (см. kreport_peak_usage).
+ * Пишется редко (раз в кадр), поэтому достаточно атомарного максимума.
  */
-static struct memory_stats stats;
+static atomic_u64 tag_peaks[MEMORY_TAG_MAX_TAGS];
+
+/*
+ * Блок статистики текущего потока.
+ */
+static KTHREAD_LOCAL memory_stats* thread_stats = 0;
+
+/*
+ * Возвращает блок статистики текущего потока, создавая его при первом вызове.
+ */
+static memory_stats* get_thread_stats() {
+    if (thread_stats) {
+        return thread_stats;
+    }
+    memory_stats* block = platform_allocate(sizeof(memory_stats), FALSE);
+    platform_zero_memory(block, sizeof(memory_stats));
+
+    // Вставляем блок в голову списка (CAS-цикл)
+    void* head = atomic_load_ptr(&stats_head, ATOMIC_ORDER_ACQUIRE);
+    do {
+        block->next = head;
+    } while (!atomic_compare_exchange_ptr(&stats_head, &head, block,
+                                          ATOMIC_ORDER_RELEASE, ATOMIC_ORDER_ACQUIRE));
+    thread_stats = block;
+    return block;
+}
+
+/*
+ * Изменяет счётчик своего потока.
+ * Писатель у счётчика один, поэтому достаточно relaxed-чтения и
+ * relaxed-записи вместо fetch_add - атомарность нужна только чтобы
+ * читатель в другом потоке не увидел "разорванное" значение.
+ */
+static inline void stats_add(atomic_u64* counter, i64 delta) {
+    atomic_store_u64(counter, atomic_load_u64(counter, ATOMIC_ORDER_RELAXED) + (u64)delta, ATOMIC_ORDER_RELAXED);
+}
 
 /*
  * Инициализирует систему управления памятью.
  * Обнуляет всю статистику, начиная отсчёт с нуля.
  */
 void initialize_memory() {
-    // Используем платформенную функцию для обнуления
-    platform_zero_memory(&stats, sizeof(stats));
+    // Блоки уже могли быть созданы - обнуляем счётчики, не трогая список
+    memory_stats* block = atomic_load_ptr(&stats_head, ATOMIC_ORDER_ACQUIRE);
+    while (block) {
+        memory_stats* next = block->next;
+        platform_zero_memory(block, sizeof(memory_stats));
+        block->next = next;
+        block = next;
+    }
 }
 
 /*
@@ -73,32 +157,107 @@ void shutdown_memory() {}
  * 
  * Возвращает:
  *   Указатель на выделенную и обнулённую память
+ */
+void* kallocate(u64 size, memory_tag tag) {
+    return kallocate_ex(size, 0, tag, KALLOCATE_FLAG_NONE);
+}
+
+/*
+ * Выделяет блок памяти с выравниванием и флагами.
  * 
  * Особенности:
  *   1. Предупреждение при использовании UNKNOWN тега
  *   2. Обновление статистики
- *   3. Автоматическое обнуление памяти после выделения
+ *   3. Обнуление памяти, если не передан KALLOCATE_FLAG_NO_ZERO
  */
-void* kallocate(u64 size, memory_tag tag) {
+void* kallocate_ex(u64 size, u64 alignment, memory_tag tag, u32 flags) {
     // Предупреждение разработчику, что нужно указать конкретный тег
     if (tag == MEMORY_TAG_UNKNOWN) {
         KWARN("kallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
+    // Выравнивание должно быть степенью двойки
+    if (alignment & (alignment - 1)) {
+        KERROR("kallocate_ex - alignment %llu is not a power of two.", alignment);
+        return 0;
+    }
     
-    // Обновляем статистику
-    stats.total_allocated += size;
-    stats.tagged_allocations[tag] += size;
-    
-    // TODO: Добавить поддержку выравнивания (alignment)
-    // Выделяем память через платформенный слой
-    void* block = platform_allocate(size, FALSE);
-    
-    // Автоматически обнуляем выделенную память
-    platform_zero_memory(block, size);
+    KPROFILE_BEGIN("kallocate");
+
+    // Обновляем статистику своего потока
+    memory_stats* stats = get_thread_stats();
+    stats_add(&stats->total_allocated, (i64)size);
+    stats_add(&stats->tagged_allocations[tag], (i64)size);
     
+    u8* block = 0;
+    if (alignment > KMEMORY_MALLOC_ALIGNMENT) {
+        // Выровненный блок: заголовок занимает конец первого шага выравнивания.
+        // У системы нет выровненного calloc, обнуляем сами
+        u8* raw = platform_allocate_aligned(size + alignment, alignment);
+        if (raw) {
+            block = raw + alignment;
+            kmemory_get_header(block)->alignment = alignment;
+            kmemory_get_header(block)->offset = alignment;
+            if (!(flags & KALLOCATE_FLAG_NO_ZERO)) {
+                platform_zero_memory(block, size);
+            }
+        }
+    } else {
+        u8* raw;
+        if (flags & KALLOCATE_FLAG_NO_ZERO) {
+            // Выделяем память через платформенный слой
+            raw = platform_allocate(size + sizeof(kmemory_header), FALSE);
+        } else {
+            // Обнулённый блок - сразу от системного аллокатора, без отдельного memset
+            raw = platform_allocate_zeroed(size + sizeof(kmemory_header), FALSE);
+        }
+        if (raw) {
+            block = raw + sizeof(kmemory_header);
+            kmemory_get_header(block)->alignment = 0;
+            kmemory_get_header(block)->offset = sizeof(kmemory_header);
+        }
+    }
+
+    KPROFILE_END("kallocate");
     return block;
 }
 
+/*
+ * Изменяет размер блока через системный realloc.
+ * Статистика меняется на разницу размеров.
+ */
+void* kreallocate(void* block, u64 old_size, u64 new_size, memory_tag tag) {
+    if (!block) {
+        return kallocate_ex(new_size, 0, tag, KALLOCATE_FLAG_NO_ZERO);
+    }
+    if (tag == MEMORY_TAG_UNKNOWN) {
+        KWARN("kreallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    u8* new_block;
+    if (kmemory_get_header(block)->alignment) {
+        // Выровненный блок системный realloc не сохранит: переносим вручную
+        u64 alignment = kmemory_get_header(block)->alignment;
+        new_block = kallocate_ex(new_size, alignment, tag, KALLOCATE_FLAG_NO_ZERO);
+        if (!new_block) {
+            return 0;
+        }
+        platform_copy_memory(new_block, block, old_size < new_size ? old_size : new_size);
+        kfree(block, old_size, tag);
+        return new_block;
+    }
+
+    u8* raw = platform_reallocate(kmemory_get_header(block), new_size + sizeof(kmemory_header));
+    if (!raw) {
+        return 0;
+    }
+    new_block = raw + sizeof(kmemory_header);
+
+    memory_stats* stats = get_thread_stats();
+    stats_add(&stats->total_allocated, (i64)new_size - (i64)old_size);
+    stats_add(&stats->tagged_allocations[tag], (i64)new_size - (i64)old_size);
+    return new_block;
+}
+
 /*
  * Освобождает ранее выделенный блок памяти.
  * 
@@ -113,18 +272,40 @@ void* kallocate(u64 size, memory_tag tag) {
  *   3. Фактическое освобождение через платформенный слой
  */
 void kfree(void* block, u64 size, memory_tag tag) {
+    kfree_ex(block, size, 0, tag);
+}
+
+/*
+ * Освобождает блок. Способ освобождения берётся из заголовка блока:
+ * выровненные блоки возвращаются через platform_free_aligned.
+ * alignment - только проверка в отладочной сборке.
+ */
+void kfree_ex(void* block, u64 size, u64 alignment, memory_tag tag) {
     // Предупреждение для UNKNOWN тега
     if (tag == MEMORY_TAG_UNKNOWN) {
         KWARN("kfree called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
+    if (!block) {
+        return;
+    }
+    kmemory_header* header = kmemory_get_header(block);
+    // Выравнивание, переданное вызывающим, должно совпадать с выделением
+    // (kfree передаёт 0 и не проверяется)
+    KASSERT_DEBUG(alignment == 0 ||
+                  (alignment <= KMEMORY_MALLOC_ALIGNMENT ? header->alignment == 0 : header->alignment == alignment));
     
-    // Обновляем статистику (вычитаем освобождённую память)
-    stats.total_allocated -= size;
-    stats.tagged_allocations[tag] -= size;
+    // Обновляем статистику своего потока (вычитаем освобождённую память)
+    memory_stats* stats = get_thread_stats();
+    stats_add(&stats->total_allocated, -(i64)size);
+    stats_add(&stats->tagged_allocations[tag], -(i64)size);
     
-    // TODO: Добавить поддержку выравнивания
     // Освобождаем память через платформенный слой
-    platform_free(block, FALSE);
+    u8* raw = (u8*)block - header->offset;
+    if (header->alignment) {
+        platform_free_aligned(raw);
+    } else {
+        platform_free(raw, FALSE);
+    }
 }
 
 /*
@@ -143,6 +324,14 @@ void* kcopy_memory(void* dest, const void* source, u64 size) {
     return platform_copy_memory(dest, source, size);
 }
 
+/*
+ * Копирует данные с учётом пересечения областей.
+ * Обёртка над platform_move_memory.
+ */
+void* kmove_memory(void* dest, const void* source, u64 size) {
+    return platform_move_memory(dest, source, size);
+}
+
 /*
  * Заполняет блок памяти заданным значением.
  * Обёртка над platform_set_memory.
@@ -151,6 +340,55 @@ void* kset_memory(void* dest, i32 value, u64 size) {
     return platform_set_memory(dest, value, size);
 }
 
+/*
+ * Запоминает пиковое заполнение для тега (атомарный максимум).
+ */
+void kreport_peak_usage(memory_tag tag, u64 peak) {
+    u64 current = atomic_load_u64(&tag_peaks[tag], ATOMIC_ORDER_RELAXED);
+    while (peak > current &&
+           !atomic_compare_exchange_u64(&tag_peaks[tag], &current, peak,
+                                        ATOMIC_ORDER_RELAXED, ATOMIC_ORDER_RELAXED)) {
+    }
+}
+
+/*
+ * Переводит размер в байтах в удобные единицы (B, KiB, MiB, GiB).
+ * 
+ * Параметры:
+ *   bytes    - размер в байтах
+ *   out_unit - буфер минимум на 4 символа для названия единицы
+ * 
+ * Возвращает:
+ *   Размер в выбранных единицах
+ */
+static f32 size_to_unit(u64 bytes, char* out_unit) {
+    // Константы для преобразования единиц
+    const u64 gib = 1024 * 1024 * 1024;  // 1 гигабайт
+    const u64 mib = 1024 * 1024;         // 1 мегабайт
+    const u64 kib = 1024;                // 1 килобайт
+
+    // Шаблон для единиц: XiB, где X = B/K/M/G
+    out_unit[0] = 'X';
+    out_unit[1] = 'i';
+    out_unit[2] = 'B';
+    out_unit[3] = 0;
+
+    // Выбираем подходящую единицу измерения
+    if (bytes >= gib) {
+        out_unit[0] = 'G';  // Гигабайты
+        return bytes / (f32)gib;
+    } else if (bytes >= mib) {
+        out_unit[0] = 'M';  // Мегабайты
+        return bytes / (f32)mib;
+    } else if (bytes >= kib) {
+        out_unit[0] = 'K';  // Килобайты
+        return bytes / (f32)kib;
+    }
+    out_unit[0] = 'B';  // Байты
+    out_unit[1] = 0;    // Обрезаем "iB", оставляем только "B"
+    return (f32)bytes;
+}
+
 /*
  * Возвращает строку с подробной статистикой использования памяти.
  * Форматирует данные в читаемый вид с автоматическим выбором единиц измерения.
@@ -161,6 +399,7 @@ void* kset_memory(void* dest, i32 value, u64 size) {
  *   ARRAY      : 1.50KB
  *   GAME       : 24.30MB
  *   TEXTURE    : 256.00MB
+ *   FRAME      : 4.00MiB (peak used: 12.50KiB)
  * 
  * Особенности:
  *   1. Автоматический выбор единиц (B, KB, MB, GB)
@@ -168,41 +407,42 @@ void* kset_memory(void* dest, i32 value, u64 size) {
  *   3. Динамическое выделение строки (нужно освобождать)
  */
 char* get_memory_usage_str() {
-    // Константы для преобразования единиц
-    const u64 gib = 1024 * 1024 * 1024;  // 1 гигабайт
-    const u64 mib = 1024 * 1024;         // 1 мегабайт
-    const u64 kib = 1024;                // 1 килобайт
-    
+    // Собираем статистику всех потоков
+    u64 tagged_allocations[MEMORY_TAG_MAX_TAGS] = {0};
+    memory_stats* block = atomic_load_ptr(&stats_head, ATOMIC_ORDER_ACQUIRE);
+    while (block) {
+        for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+            tagged_allocations[i] += atomic_load_u64(&block->tagged_allocations[i], ATOMIC_ORDER_RELAXED);
+        }
+        block = block->next;
+    }
+
     // Буфер для формирования строки (8000 байт должно хватить)
     char buffer[8000] = "System memory use (tagged):\n";
     u64 offset = strlen(buffer);  // Текущая позиция в буфере
     
     // Проходим по всем тегам и добавляем их статистику
     for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
-        char unit[4] = "XiB";  // Шаблон для единиц: XiB, где X = B/K/M/G
-        float amount = 1.0f;
-        
-        // Выбираем подходящую единицу измерения
-        if (stats.tagged_allocations[i] >= gib) {
-            unit[0] = 'G';  // Гигабайты
-            amount = stats.tagged_allocations[i] / (float)gib;
-        } else if (stats.tagged_allocations[i] >= mib) {
-            unit[0] = 'M';  // Мегабайты
-            amount = stats.tagged_allocations[i] / (float)mib;
-        } else if (stats.tagged_allocations[i] >= kib) {
-            unit[0] = 'K';  // Килобайты
-            amount = stats.tagged_allocations[i] / (float)kib;
-        } else {
-            unit[0] = 'B';  // Байты
-            unit[1] = 0;    // Обрезаем "iB", оставляем только "B"
-            amount = (float)stats.tagged_allocations[i];
-        }
+        char unit[4];
+        f32 amount = size_to_unit(tagged_allocations[i], unit);
         
         // Форматируем строку для текущего тега
-        i32 length = snprintf(buffer + offset, 8000, 
-                              "  %s: %.2f%s\n", 
+        i32 length = snprintf(buffer + offset, sizeof(buffer) - offset, 
+                              "  %s: %.2f%s", 
                               memory_tag_strings[i], amount, unit);
         offset += length;  // Сдвигаем позицию для следующей записи
+
+        // Для тегов с отчётом о заполнении добавляем пик
+        u64 peak = atomic_load_u64(&tag_peaks[i], ATOMIC_ORDER_RELAXED);
+        if (peak > 0) {
+            char peak_unit[4];
+            f32 peak_amount = size_to_unit(peak, peak_unit);
+            length = snprintf(buffer + offset, sizeof(buffer) - offset,
+                              " (peak used: %.2f%s)", peak_amount, peak_unit);
+            offset += length;
+        }
+        length = snprintf(buffer + offset, sizeof(buffer) - offset, "\n");
+        offset += length;
     }
     
     // Создаём копию строки для возврата (вызывающий должен освободить)
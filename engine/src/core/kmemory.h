@@ -30,10 +30,21 @@ typedef enum memory_tag {
     MEMORY_TAG_ENTITY,           // Сущности
     MEMORY_TAG_ENTITY_NODE,      // Узлы сущностей (иерархия)
     MEMORY_TAG_SCENE,            // Сцены
+    MEMORY_TAG_LINEAR_ALLOCATOR, // Блоки линейных аллокаторов
+    MEMORY_TAG_FRAME,            // Кадровая арена (живёт один кадр)
     
     MEMORY_TAG_MAX_TAGS          // Маркер конца (для массивов)
 } memory_tag;
 
+/*
+ * Флаги выделения памяти для kallocate_ex.
+ * Комбинируются через побитовое ИЛИ.
+ */
+typedef enum kallocate_flags {
+    KALLOCATE_FLAG_NONE = 0x0,     // Обычное выделение: память обнулена
+    KALLOCATE_FLAG_NO_ZERO = 0x1   // Не обнулять: вызывающий сам заполнит блок
+} kallocate_flags;
+
 /*
  * Инициализирует систему управления памятью.
  * Должна быть вызвана перед любыми выделениями через kallocate.
@@ -58,6 +69,48 @@ KAPI void shutdown_memory();
  */
 KAPI void* kallocate(u64 size, memory_tag tag);
 
+/*
+ * Выделяет блок памяти с дополнительными параметрами.
+ * kallocate(size, tag) эквивалентен kallocate_ex(size, 0, tag, KALLOCATE_FLAG_NONE).
+ * 
+ * Параметры:
+ *   size      - размер в байтах для выделения
+ *   alignment - требуемое выравнивание, степень двойки (0 - по умолчанию,
+ *               16 байт). Например 32/64 для SIMD и атомиков в своей
+ *               кэш-линии, 4096 для страничных буферов.
+ *   tag       - категория памяти
+ *   flags     - комбинация kallocate_flags
+ * 
+ * Обнуление без KALLOCATE_FLAG_NO_ZERO делается самим системным
+ * аллокатором (calloc): для больших блоков ОС отдаёт уже чистые
+ * страницы, и лишнего прохода memset по памяти нет.
+ * 
+ * Выравнивание запоминается в заголовке перед блоком, поэтому любой
+ * блок можно освободить и через kfree, и через kfree_ex.
+ * 
+ * Возвращает:
+ *   Указатель на выделенную память или NULL при ошибке
+ */
+KAPI void* kallocate_ex(u64 size, u64 alignment, memory_tag tag, u32 flags);
+
+/*
+ * Изменяет размер блока, выделенного через kallocate или kallocate_ex.
+ * По возможности блок растёт/сжимается на месте, без копирования
+ * (выровненный больше чем на 16 байт блок всегда переносится).
+ * Байты сверх old_size не обнуляются.
+ * 
+ * Параметры:
+ *   block    - блок (может быть 0, тогда это обычное выделение)
+ *   old_size - текущий размер блока
+ *   new_size - новый размер блока
+ *   tag      - тег, с которым был выделен блок
+ * 
+ * Возвращает:
+ *   Указатель на блок (может отличаться от block) или 0 при ошибке,
+ *   в этом случае старый блок остаётся действительным
+ */
+KAPI void* kreallocate(void* block, u64 old_size, u64 new_size, memory_tag tag);
+
 /*
  * Освобождает ранее выделенный блок памяти.
  * 
@@ -71,6 +124,20 @@ KAPI void* kallocate(u64 size, memory_tag tag);
  */
 KAPI void kfree(void* block, u64 size, memory_tag tag);
 
+/*
+ * Освобождает блок, выделенный через kallocate_ex.
+ * 
+ * Параметры:
+ *   block     - указатель на блок для освобождения
+ *   size      - размер блока (как при выделении)
+ *   alignment - выравнивание (как при выделении)
+ *   tag       - тег, с которым был выделен блок
+ * 
+ * Примечание: способ освобождения берётся из заголовка блока;
+ * alignment сверяется с ним в отладочной сборке.
+ */
+KAPI void kfree_ex(void* block, u64 size, u64 alignment, memory_tag tag);
+
 /*
  * Обнуляет блок памяти заданного размера.
  * Полезно для инициализации структур.
@@ -97,6 +164,19 @@ KAPI void* kzero_memory(void* block, u64 size);
  */
 KAPI void* kcopy_memory(void* dest, const void* source, u64 size);
 
+/*
+ * Копирует данные из source в dest, области могут пересекаться (memmove).
+ * 
+ * Параметры:
+ *   dest   - целевой блок памяти
+ *   source - источник данных
+ *   size   - количество байт для копирования
+ * 
+ * Возвращает:
+ *   Указатель на dest
+ */
+KAPI void* kmove_memory(void* dest, const void* source, u64 size);
+
 /*
  * Заполняет блок памяти заданным значением.
  * 
@@ -110,6 +190,19 @@ KAPI void* kcopy_memory(void* dest, const void* source, u64 size);
  */
 KAPI void* kset_memory(void* dest, i32 value, u64 size);
 
+/*
+ * Сообщает пиковое заполнение памяти с тегом tag.
+ * Нужна для аллокаторов, которые держат большой блок и раздают его
+ * по частям (например, кадровая арена): сам блок учитывается через
+ * kallocate, а насколько он реально заполнялся - через эту функцию.
+ * Хранится максимум из всех переданных значений.
+ * 
+ * Параметры:
+ *   tag  - тег блока
+ *   peak - текущее пиковое заполнение в байтах
+ */
+KAPI void kreport_peak_usage(memory_tag tag, u64 peak);
+
 /*
  * Возвращает строку с информацией об использовании памяти.
  * Формат: статистика по каждому тегу.
@@ -11,42 +11,252 @@
 #include <defines.h>
 #include <platform/platform.h>
 #include <core/asserts.h>
+#include <core/profiler.h>
+#include <containers/mpsc_queue.h>
 
-// TODO: temporary
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
+// Максимальная длина одного сообщения лога (с префиксом уровня)
+#define LOG_MESSAGE_MAX_LENGTH 32000
+
+// Размер записи в очереди асинхронного логгера. Сообщения, которые в неё
+// не помещаются, пишутся синхронно (после выталкивания очереди)
+#define LOG_RECORD_SIZE 512
+
+// Количество записей в очереди (степень двойки): 4096 * 512 = 2 МиБ
+#define LOG_QUEUE_CAPACITY 4096
+
+// Сколько поток записи спит без сигналов, прежде чем проверить очередь сам
+#define LOG_WRITER_IDLE_TIMEOUT_MS 100
+
+// Длина префикса уровня ("[FATAL]: ")
+#define LOG_LEVEL_PREFIX_LENGTH 9
+
+/*
+ * Запись очереди: уже отформатированное сообщение.
+ */
+typedef struct log_record {
+  u32 level;
+  u32 length;  // длина text без завершающего нуля
+  char text[LOG_RECORD_SIZE - 2 * sizeof(u32)];
+} log_record;
+
+/*
+ * Состояние асинхронного логгера.
+ * Любой поток кладёт записи в lock-free очередь, один фоновый поток
+ * забирает их пачками и пишет на консоль.
+ */
+typedef struct logger_state {
+  atomic_u32 async;            // асинхронный режим включён
+  atomic_u32 running;          // поток записи должен работать
+  atomic_u32 overflow_policy;  // log_overflow_policy
+  mpsc_queue queue;
+  platform_thread writer;
+  platform_semaphore wake;     // будит поток записи
+  atomic_u32 writer_sleeping;  // поток записи спит на семафоре
+  atomic_u64 written;          // записей выведено (и вытолкнуто) потоком записи
+  atomic_u64 dropped;          // отброшено при переполнении, всего
+  atomic_u64 dropped_unreported;  // отброшено с последнего отчёта в лог
+} logger_state;
+
+static logger_state state;
+
+// Поток записи сам ничего не ставит в очередь: его собственные сообщения
+// (ошибки файлового вывода) пишутся сразу, иначе при полной очереди он
+// ждал бы сам себя
+static KTHREAD_LOCAL b8 on_writer_thread = FALSE;
+
+atomic_u32 logger_level = {LOG_LEVEL_TRACE};
+
+// Массив строк, который соответствует разным уровням логирования:
+//[FATAL]: — для фатальных ошибок.
+//[ERROR]: — для обычных ошибок.
+//[WARN]: — для предупреждений.
+//[INFO]: — для информационных сообщений.
+//[DEBUG]: — для сообщений уровня отладки.
+//[TRACE]: — для трассировочных сообщений.
+static const char *level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ",
+                                       "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
+
+// Вывод готового сообщения с учётом платформы и в файл лога
+static void logger_write(log_level level, const char *text, u64 length) {
+  if (level < LOG_LEVEL_WARN) {
+    platform_console_write_error(text, level);
+  } else {
+    platform_console_write(text, level);
+  }
+  log_file_write(level, text, length);
+}
+
+// Забирает из очереди всё, что есть, и выводит одной пачкой.
+// Возвращает количество выведенных записей
+static u64 logger_drain() {
+  log_record record;
+  u64 count = 0;
+  while (mpsc_queue_pop(&state.queue, &record)) {
+    logger_write((log_level)record.level, record.text, record.length);
+    count++;
+  }
+
+  // Сообщаем о потерянных сообщениях, чтобы пропуск в логе был виден
+  u64 dropped = atomic_exchange_u64(&state.dropped_unreported, 0, ATOMIC_ORDER_RELAXED);
+  if (dropped) {
+    char notice[128];
+    i32 length = snprintf(notice, sizeof(notice), "%slogger queue overflow, %llu message(s) dropped.\n",
+                          level_strings[LOG_LEVEL_WARN], dropped);
+    logger_write(LOG_LEVEL_WARN, notice, (u64)length);
+  }
+
+  if (count || dropped) {
+    // Один системный вызов на пачку
+    platform_console_flush();
+    atomic_fetch_add_u64(&state.written, count, ATOMIC_ORDER_RELEASE);
+  }
+  return count;
+}
+
+// Поток записи
+static u32 logger_writer_thread(void *params) {
+  on_writer_thread = TRUE;
+  profiler_set_thread_name("log writer");
+  for (;;) {
+    if (logger_drain()) {
+      continue;
+    }
+    if (!atomic_load_u32(&state.running, ATOMIC_ORDER_ACQUIRE)) {
+      // Очередь пуста и нас просят завершиться
+      break;
+    }
+
+    // Объявляем, что засыпаем, и проверяем очередь ещё раз: производитель
+    // мог положить запись до того, как увидел флаг
+    atomic_store_u32(&state.writer_sleeping, 1, ATOMIC_ORDER_SEQ_CST);
+    if (logger_drain()) {
+      atomic_store_u32(&state.writer_sleeping, 0, ATOMIC_ORDER_RELAXED);
+      continue;
+    }
+    // Очередь пуста: самое время отдать накопленное в файл
+    log_file_flush();
+    platform_semaphore_wait(&state.wake, LOG_WRITER_IDLE_TIMEOUT_MS);
+    atomic_store_u32(&state.writer_sleeping, 0, ATOMIC_ORDER_RELAXED);
+  }
+  return 0;
+}
+
+// Будит поток записи, если он спит. Системный вызов - только в этом случае
+static void logger_wake_writer() {
+  atomic_fence(ATOMIC_ORDER_SEQ_CST);
+  if (atomic_load_u32(&state.writer_sleeping, ATOMIC_ORDER_RELAXED) &&
+      atomic_exchange_u32(&state.writer_sleeping, 0, ATOMIC_ORDER_SEQ_CST)) {
+    platform_semaphore_signal(&state.wake);
+  }
+}
+
+// Кладёт запись в очередь с учётом политики переполнения.
+// Ошибки и фатальные сообщения не отбрасываются никогда
+static void logger_enqueue(const log_record *record) {
+  if (on_writer_thread) {
+    logger_write((log_level)record->level, record->text, record->length);
+    return;
+  }
+  while (!mpsc_queue_push(&state.queue, record)) {
+    if (record->level > LOG_LEVEL_ERROR &&
+        atomic_load_u32(&state.overflow_policy, ATOMIC_ORDER_RELAXED) == LOG_OVERFLOW_DROP) {
+      atomic_fetch_add_u64(&state.dropped, 1, ATOMIC_ORDER_RELAXED);
+      atomic_fetch_add_u64(&state.dropped_unreported, 1, ATOMIC_ORDER_RELAXED);
+      return;
+    }
+    // Ждём, пока поток записи освободит место
+    platform_semaphore_signal(&state.wake);
+    platform_sleep(0);
+  }
+  logger_wake_writer();
+}
+
 b8 initialize_logging() {
-  // TODO: create log file.
+  // Файл лога открывается отдельно, logger_file_begin
+#if LOG_ASYNC_ENABLED == 1
+  if (atomic_load_u32(&state.async, ATOMIC_ORDER_ACQUIRE)) {
+    return TRUE;
+  }
+  if (!mpsc_queue_create(LOG_QUEUE_CAPACITY, sizeof(log_record), &state.queue)) {
+    return FALSE;
+  }
+  if (!platform_semaphore_create(0, &state.wake)) {
+    mpsc_queue_destroy(&state.queue);
+    return FALSE;
+  }
+  atomic_store_u32(&state.running, TRUE, ATOMIC_ORDER_RELAXED);
+  atomic_store_u64(&state.written, 0, ATOMIC_ORDER_RELAXED);
+  if (!platform_thread_create(logger_writer_thread, 0, &state.writer)) {
+    // Без потока записи остаёмся в синхронном режиме
+    platform_semaphore_destroy(&state.wake);
+    mpsc_queue_destroy(&state.queue);
+    atomic_store_u32(&state.running, FALSE, ATOMIC_ORDER_RELAXED);
+    return TRUE;
+  }
+  atomic_store_u32(&state.async, TRUE, ATOMIC_ORDER_RELEASE);
+#endif
   return TRUE;
 }
 
 void shutdown_logging() {
-  // TODO: cleanup logging/write queued entries.
+  // Дописываем буферы двоичного лога, если он вёлся
+  logger_binary_end();
+
+  if (!atomic_load_u32(&state.async, ATOMIC_ORDER_ACQUIRE)) {
+    platform_console_flush();
+    logger_file_end();
+    return;
+  }
+  // Новые сообщения идут синхронно; поток записи дописывает очередь и выходит
+  atomic_store_u32(&state.async, FALSE, ATOMIC_ORDER_RELEASE);
+  atomic_store_u32(&state.running, FALSE, ATOMIC_ORDER_RELEASE);
+  platform_semaphore_signal(&state.wake);
+  platform_thread_join(&state.writer);
+
+  platform_semaphore_destroy(&state.wake);
+  mpsc_queue_destroy(&state.queue);
+  logger_file_end();
+}
+
+void logger_flush() {
+  // Поток записи не может ждать сам себя: у него очередь и так выводится
+  // по порядку, достаточно вытолкнуть буферы
+  if (!atomic_load_u32(&state.async, ATOMIC_ORDER_ACQUIRE) || on_writer_thread) {
+    platform_console_flush();
+    log_file_flush();
+    return;
+  }
+  // Ждём, пока поток записи выведет всё, что было занято в очереди к этому
+  // моменту (занятые позиции и счётчик выведенного начинаются с нуля)
+  u64 target = mpsc_queue_enqueued_count(&state.queue);
+  platform_semaphore_signal(&state.wake);
+  while (atomic_load_u64(&state.written, ATOMIC_ORDER_ACQUIRE) < target) {
+    platform_sleep(0);
+  }
+  log_file_flush();
+}
+
+void logger_set_level(log_level level) {
+  atomic_store_u32(&logger_level, (u32)level, ATOMIC_ORDER_RELAXED);
+}
+
+log_level logger_get_level() {
+  return (log_level)atomic_load_u32(&logger_level, ATOMIC_ORDER_RELAXED);
+}
+
+void logger_set_overflow_policy(log_overflow_policy policy) {
+  atomic_store_u32(&state.overflow_policy, (u32)policy, ATOMIC_ORDER_RELAXED);
+}
+
+u64 logger_dropped_count() {
+  return atomic_load_u64(&state.dropped, ATOMIC_ORDER_RELAXED);
 }
 
 void log_output(log_level level, const char *message, ...) {
-  // Массив строк, который соответствует разным уровням логирования:
-  //[FATAL]: — для фатальных ошибок.
-  //[ERROR]: — для обычных ошибок.
-  //[WARN]: — для предупреждений.
-  //[INFO]: — для информационных сообщений.
-  //[DEBUG]: — для сообщений уровня отладки.
-  //[TRACE]: — для трассировочных сообщений.
-  const char *level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ",
-                                  "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
-  b8 is_error = level < LOG_LEVEL_WARN;
-
-  // Буфер для хранения отформатированного сообщения лога. Он имеет размер 32
-  // 000 байт (32 КБ), что накладывает ограничение на длину одного сообщения.
-  const i32 msg_length = 32000;
-  char out_message[msg_length];
-  // Функция memset гарантирует, что все байты массива out_message будут
-  // установлены в значение 0. Это важно для того, чтобы избежать случайных
-  // значений в памяти, если массив используется позже, например, для строкового
-  // вывода.
-  memset(out_message, 0, sizeof(out_message));
   // ПРИМЕЧАНИЕ: Странно, но заголовки MS перекрывают тип GCC/Clang va_list с
   // помощью «typedef char* va_list» в некоторых кейсах, и в результате здесь
   // возникает странная ошибка. Пока что обходной путь — просто использовать
@@ -54,26 +264,67 @@ void log_output(log_level level, const char *message, ...) {
   __builtin_va_list arg_ptr;
   // инициализирует список аргументов для дальнейшего использования в vsnprintf.
   va_start(arg_ptr, message);
-  // формирует строку сообщения, используя формат и переменные, переданные в лог
-  // (через message и переменные аргументы ...).
-  vsnprintf(out_message, msg_length, message, arg_ptr);
+  log_output_va(level, message, arg_ptr);
   // завершение использования переменного списка аргументов
   va_end(arg_ptr);
-  // окончательный массив с сообщением
-  char out_message2[msg_length];
-  // Формирует окончательное сообщение лога, добавляя к отформатированному
-  // сообщению префикс, который соответствует уровню логирования. Например,
-  // [INFO]: или [ERROR]:.
-  sprintf(out_message2, "%s%s\n", level_strings[level], out_message);
-  // Сообщение выводится на консоль с помощью printf. Это предполагает, что в
-  // будущем можно будет добавить поддержку других типов вывода, например, в
-  // файл или на платформенные средства вывода
-  // Вывод с учитыванием платформы
-  if (is_error) {
-    platform_console_write_error(out_message2, level);
-  } else {
-    platform_console_write(out_message2, level);
+}
+
+void log_output_va(log_level level, const char *message, __builtin_va_list args) {
+  KPROFILE_BEGIN("log_output");
+  // Сообщения самого потока записи (например, об ошибке открытия файла при
+  // ротации) идут синхронным путём: ждать очередь ему некому
+  if (atomic_load_u32(&state.async, ATOMIC_ORDER_ACQUIRE) && !on_writer_thread) {
+    // Быстрый путь: форматируем сразу в запись очереди, без memset и
+    // промежуточных буферов, и отдаём её потоку записи
+    log_record record;
+    record.level = level;
+    memcpy(record.text, level_strings[level], LOG_LEVEL_PREFIX_LENGTH);
+    u64 capacity = sizeof(record.text) - LOG_LEVEL_PREFIX_LENGTH - 1;  // место под '\n'
+    // Копия списка: при длинном сообщении форматируем его ещё раз
+    __builtin_va_list args_copy;
+    va_copy(args_copy, args);
+    i32 length = vsnprintf(record.text + LOG_LEVEL_PREFIX_LENGTH, capacity, message, args_copy);
+    va_end(args_copy);
+
+    if (length >= 0 && (u64)length < capacity) {
+      u32 end = LOG_LEVEL_PREFIX_LENGTH + (u32)length;
+      record.text[end] = '\n';
+      record.text[end + 1] = 0;
+      record.length = end + 1;
+      logger_enqueue(&record);
+      if (level == LOG_LEVEL_FATAL) {
+        // После фатальной ошибки процесс может тут же упасть
+        logger_flush();
+      }
+      KPROFILE_END("log_output");
+      return;
+    }
+    // Длинное сообщение: выталкиваем очередь, чтобы сохранить порядок,
+    // и пишем синхронно
+    logger_flush();
+  }
+
+  // Синхронный путь: один буфер, префикс копируется, сообщение форматируется
+  // сразу за ним
+  char out_message[LOG_MESSAGE_MAX_LENGTH];
+  memcpy(out_message, level_strings[level], LOG_LEVEL_PREFIX_LENGTH);
+  u64 capacity = sizeof(out_message) - LOG_LEVEL_PREFIX_LENGTH - 1;
+  i32 length = vsnprintf(out_message + LOG_LEVEL_PREFIX_LENGTH, capacity, message, args);
+  if (length < 0) {
+    length = 0;
+  } else if ((u64)length >= capacity) {
+    // Обрезано vsnprintf
+    length = (i32)capacity - 1;
+  }
+  u32 end = LOG_LEVEL_PREFIX_LENGTH + (u32)length;
+  out_message[end] = '\n';
+  out_message[end + 1] = 0;
+
+  logger_write(level, out_message, end + 1);
+  if (level == LOG_LEVEL_FATAL) {
+    platform_console_flush();
   }
+  KPROFILE_END("log_output");
 }
 
 // expression — строковое представление выражения, которое вызвало сбой.
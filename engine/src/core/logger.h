@@ -9,6 +9,7 @@
 #pragma once
 
 #include <defines.h>
+#include <platform/atomic.h>
 
 /* Конфигурация уровня логирования: */
 #define LOG_WARN_ENABLED                                                       \
@@ -20,8 +21,18 @@
 #define LOG_TRACE_ENABLED                                                      \
   1 // позволяет логировать сообщения на уровне трассировки (trace).
 
-/* Отключение логирования для релизных сборок */
-#if KRELEASE == 1
+/* Двоичный режим для KDEBUG/KTRACE: место вызова записывает только
+   идентификатор строки формата и сырые аргументы, форматирование делается
+   потом, утилитой tools/log_decoder. Пока двоичный лог не запущен
+   (logger_binary_begin), сообщения выводятся как обычно текстом. */
+#define LOG_BINARY_ENABLED 1
+
+/* Отключение логирования для релизных сборок.
+   С двоичным режимом KDEBUG/KTRACE остаются: без запущенного двоичного лога
+   они стоят одну проверку и ничего не форматируют. */
+#if KRELEASE == 1 && LOG_BINARY_ENABLED != 1
+#undef LOG_DEBUG_ENABLED
+#undef LOG_TRACE_ENABLED
 #define LOG_DEBUG_ENABLED 0
 #define LOG_TRACE_ENABLED 0
 #endif
@@ -42,10 +53,51 @@ typedef enum log_level {
                       // состояния программы в реальном времени.
 } log_level;
 
+/* Асинхронный режим: initialize_logging запускает фоновый поток записи.
+   Вызывающий поток только форматирует сообщение и кладёт его в lock-free
+   очередь; вывод на консоль идёт пачками в фоновом потоке. До вызова
+   initialize_logging и после shutdown_logging вывод синхронный. */
+#define LOG_ASYNC_ENABLED 1
+
+/* Что делать, если очередь асинхронного логгера заполнена */
+typedef enum log_overflow_policy {
+  LOG_OVERFLOW_DROP = 0,  // отбросить сообщение (ERROR и FATAL не отбрасываются)
+  LOG_OVERFLOW_BLOCK = 1  // ждать, пока поток записи освободит место
+} log_overflow_policy;
+
+/* Текущий уровень логирования, задаётся во время работы. Макросы
+   сравнивают с ним уровень сообщения до вызова log_output, поэтому
+   отключённое сообщение стоит одно сравнение и ничего не форматирует.
+   Дефайны LOG_*_ENABLED выше остаются верхней границей: убранное ими
+   при компиляции уже не включить. */
+KAPI extern atomic_u32 logger_level;
+
+// Включён ли уровень level. Чтение relaxed: уровень меняют из любого
+// потока, но порядок с другими данными не важен
+static inline b8 logger_level_enabled(log_level level) {
+  return (u32)level <= atomic_load_u32(&logger_level, ATOMIC_ORDER_RELAXED);
+}
+
+// Выводить сообщения с уровнем не подробнее level (по умолчанию LOG_LEVEL_TRACE)
+KAPI void logger_set_level(log_level level);
+KAPI log_level logger_get_level();
+
 /* Функции для инициализации и завершения логирования */
+// Запускает поток записи (если LOG_ASYNC_ENABLED)
 b8 initialize_logging();
+// Дописывает очередь, останавливает поток записи и закрывает файлы лога
 void shutdown_logging();
 
+// Ждёт, пока все поставленные к этому моменту сообщения будут выведены.
+// Вызывается автоматически после KFATAL
+KAPI void logger_flush();
+
+// Политика переполнения очереди (по умолчанию LOG_OVERFLOW_DROP)
+KAPI void logger_set_overflow_policy(log_overflow_policy policy);
+
+// Сколько сообщений отброшено из-за переполнения очереди
+KAPI u64 logger_dropped_count();
+
 /* Основная функция для вывода логов */
 // level — уровень логирования.
 // message — само сообщение (строка, которая будет выведена в лог).
@@ -54,6 +106,55 @@ void shutdown_logging();
 // например, с printf.
 KAPI void log_output(log_level level, const char *message, ...);
 
+// То же, что log_output, но с уже собранным списком аргументов
+void log_output_va(log_level level, const char *message, __builtin_va_list args);
+
+/* Файл лога */
+
+typedef struct log_file_config {
+  // Основной файл, все уровни
+  const char *path;
+  // Порог ротации в байтах (0 - без ротации)
+  u64 max_size;
+  // Сколько старых файлов хранить: path.1 (новейший) ... path.max_files.
+  // 0 - при достижении порога файл начинается заново
+  u32 max_files;
+  // Дополнительно писать каждый уровень в свой файл: path.error, path.warn...
+  b8 per_level_files;
+} log_file_config;
+
+// Открывает файл лога. Сообщения идут и на консоль, и в файл
+KAPI b8 logger_file_begin(const log_file_config *config);
+
+// Дописывает буферы и закрывает файлы лога
+KAPI void logger_file_end();
+
+// Запись готового сообщения (с префиксом и '\n') в файлы лога
+void log_file_write(log_level level, const char *text, u64 length);
+
+// Отдаёт буферы файлов лога в ОС
+void log_file_flush();
+
+/* Двоичный лог */
+
+// Начинает двоичный лог в файл path. TRUE - файл открыт
+KAPI b8 logger_binary_begin(const char *path);
+
+// Дописывает буферы всех потоков и закрывает файл. Рабочие потоки к этому
+// моменту должны быть остановлены (их буферы пишутся без блокировки)
+KAPI void logger_binary_end();
+
+// Дописывает в файл буфер вызывающего потока (например, перед его завершением)
+KAPI void logger_binary_flush_thread();
+
+// Запись двоичного сообщения. format_id - статическая переменная места
+// вызова (0 до первой записи), в ней кэшируется идентификатор формата.
+// Поддерживаются %d %i %u %x %X %o %c (с модификаторами hh h l ll z j t),
+// %f %e %g %a, %s, %p и ширина/точность через '*'. Формат с другими
+// спецификаторами (или больше LOG_BINARY_MAX_ARGS аргументов) выводится текстом
+KAPI void log_binary(atomic_u32 *format_id, log_level level,
+                     const char *format, ...);
+
 /* Макросы для удобного логирования */
 
 // Используется для логирования фатальных ошибок, которые обычно означают
@@ -61,40 +162,73 @@ KAPI void log_output(log_level level, const char *message, ...);
 #define KFATAL(message, ...)                                                   \
   log_output(LOG_LEVEL_FATAL, message, ##__VA_ARGS__);
 
+// Остальные уровни проверяют logger_level до форматирования
+
 // Этот макрос логирует ошибки. Если макрос KERROR уже определён в другом месте,
 // он не будет переопределяться.
 #ifndef KERROR
 #define KERROR(message, ...)                                                   \
-  log_output(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
+  {                                                                            \
+    if (logger_level_enabled(LOG_LEVEL_ERROR))                                 \
+      log_output(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);                     \
+  }
 #endif
 
 // Логирует предупреждения только если LOG_WARN_ENABLED равен 1. Если
 // предупреждения отключены, макрос не делает ничего.
 #if LOG_WARN_ENABLED == 1
-#define KWARN(message, ...) log_output(LOG_LEVEL_WARN, message, ##__VA_ARGS__);
+#define KWARN(message, ...)                                                    \
+  {                                                                            \
+    if (logger_level_enabled(LOG_LEVEL_WARN))                                  \
+      log_output(LOG_LEVEL_WARN, message, ##__VA_ARGS__);                      \
+  }
 #else
 #define KWARN(message, ...)
 #endif
 
 // Логирует информационные сообщения только если LOG_INFO_ENABLED равен 1.
 #if LOG_INFO_ENABLED == 1
-#define KINFO(message, ...) log_output(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
+#define KINFO(message, ...)                                                    \
+  {                                                                            \
+    if (logger_level_enabled(LOG_LEVEL_INFO))                                  \
+      log_output(LOG_LEVEL_INFO, message, ##__VA_ARGS__);                      \
+  }
 #else
 #define KINFO(message, ...)
 #endif
 
 // Логирует сообщения для отладки только если LOG_DEBUG_ENABLED равен 1.
-#if LOG_DEBUG_ENABLED == 1
+#if LOG_DEBUG_ENABLED == 1 && LOG_BINARY_ENABLED == 1
 #define KDEBUG(message, ...)                                                   \
-  log_output(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+  {                                                                            \
+    static atomic_u32 _log_format_id = {0};                                    \
+    if (logger_level_enabled(LOG_LEVEL_DEBUG))                                 \
+      log_binary(&_log_format_id, LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);    \
+  }
+#elif LOG_DEBUG_ENABLED == 1
+#define KDEBUG(message, ...)                                                   \
+  {                                                                            \
+    if (logger_level_enabled(LOG_LEVEL_DEBUG))                                 \
+      log_output(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);                     \
+  }
 #else
 #define KDEBUG(message, ...)
 #endif
 
 // Логирует трассировочные сообщения только если LOG_TRACE_ENABLED равен 1.
-#if LOG_TRACE_ENABLED == 1
+#if LOG_TRACE_ENABLED == 1 && LOG_BINARY_ENABLED == 1
+#define KTRACE(message, ...)                                                   \
+  {                                                                            \
+    static atomic_u32 _log_format_id = {0};                                    \
+    if (logger_level_enabled(LOG_LEVEL_TRACE))                                 \
+      log_binary(&_log_format_id, LOG_LEVEL_TRACE, message, ##__VA_ARGS__);    \
+  }
+#elif LOG_TRACE_ENABLED == 1
 #define KTRACE(message, ...)                                                   \
-  log_output(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+  {                                                                            \
+    if (logger_level_enabled(LOG_LEVEL_TRACE))                                 \
+      log_output(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);                     \
+  }
 #else
 #define KTRACE(message, ...)
 #endif
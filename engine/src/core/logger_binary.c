@@ -0,0 +1,356 @@
+/*
+
+   Двоичный лог: KDEBUG/KTRACE без форматирования на месте вызова.
+
+   Место вызова один раз регистрирует строку формата (разбирает её и
+   запоминает типы аргументов), дальше каждое сообщение - это идентификатор
+   формата, время и сырые аргументы, дописанные в буфер своего потока.
+   Полный буфер уходит в файл одним блоком. Текст собирает утилита
+   tools/log_decoder.
+
+*/
+
+#include "core/logger.h"
+#include "core/logger_binary_format.h"
+#include "core/kmemory.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+#include "platform/atomic.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+// Буфер записей одного потока
+#define LOG_BINARY_THREAD_BUFFER_SIZE (64 * 1024)
+
+// Сколько разных мест вызова можно зарегистрировать
+#define LOG_BINARY_MAX_FORMATS 4096
+
+// Идентификатор формата, который не поддерживается: такие сообщения всегда
+// идут текстом. В переменной места вызова хранится как есть, остальные
+// идентификаторы - как id + 1 (0 - ещё не зарегистрирован)
+#define LOG_BINARY_FORMAT_UNSUPPORTED 0xFFFFFFFF
+
+// Разобранный формат места вызова
+typedef struct log_binary_format {
+    const char* format;  // строка формата места вызова (литерал)
+    u8 level;
+    u8 arg_count;
+    u8 arg_types[LOG_BINARY_MAX_ARGS];
+    // Точность аргумента-строки (LOG_BINARY_PRECISION_*): больше неё
+    // байт строки не читается - "%.*s" бывает на буфере без завершающего нуля
+    i32 arg_precisions[LOG_BINARY_MAX_ARGS];
+} log_binary_format;
+
+// Буфер потока. Все буферы связаны в список, чтобы при завершении
+// дописать и освободить их, в том числе от уже завершившихся потоков
+typedef struct log_thread_buffer {
+    u8* data;
+    u32 used;
+    u16 thread_index;
+    struct log_thread_buffer* next;
+} log_thread_buffer;
+
+typedef struct log_binary_state {
+    atomic_u32 active;
+    file_handle file;
+    platform_mutex file_lock;  // запись блоков в файл
+    atomic_u32 next_format_id;
+    atomic_u32 next_thread_index;
+    log_binary_format formats[LOG_BINARY_MAX_FORMATS];
+    atomic_ptr buffers_head;  // log_thread_buffer*
+    atomic_u32 session;  // растёт в logger_binary_end: буферы прошлых сеансов освобождены
+} log_binary_state;
+
+static log_binary_state state;
+static KTHREAD_LOCAL log_thread_buffer* thread_buffer = 0;
+// Сеанс, в котором создан thread_buffer. Буферы освобождает logger_binary_end
+// в своём потоке, обнулить указатели других потоков он не может - по
+// несовпадению сеанса поток понимает, что его буфер уже освобождён
+static KTHREAD_LOCAL u32 thread_buffer_session = 0;
+
+//действителен ли буфер вызывающего потока в текущем сеансе
+static b8 log_binary_has_buffer() {
+    return thread_buffer && thread_buffer_session == atomic_load_u32(&state.session, ATOMIC_ORDER_ACQUIRE);
+}
+
+//пишет блок в файл под мьютексом (блоки разных потоков не перемешиваются)
+static void log_binary_write_block(const void* data, u64 size) {
+    platform_mutex_lock(&state.file_lock);
+    u64 written = 0;
+    filesystem_write(&state.file, size, data, &written);
+    platform_mutex_unlock(&state.file_lock);
+}
+
+//сбрасывает буфер потока в файл
+static void log_binary_flush_buffer(log_thread_buffer* buffer) {
+    if (buffer->used > 0) {
+        log_binary_write_block(buffer->data, buffer->used);
+        buffer->used = 0;
+    }
+}
+
+//буфер вызывающего потока (создаётся при первом сообщении)
+static log_thread_buffer* log_binary_get_buffer() {
+    if (log_binary_has_buffer()) {
+        return thread_buffer;
+    }
+    log_thread_buffer* buffer = kallocate(sizeof(log_thread_buffer), MEMORY_TAG_ARRAY);
+    buffer->data = kallocate_ex(LOG_BINARY_THREAD_BUFFER_SIZE, 0, MEMORY_TAG_ARRAY, KALLOCATE_FLAG_NO_ZERO);
+    buffer->used = 0;
+    buffer->thread_index = (u16)atomic_fetch_add_u32(&state.next_thread_index, 1, ATOMIC_ORDER_RELAXED);
+
+    // Вставляем в голову списка (CAS-цикл)
+    void* head = atomic_load_ptr(&state.buffers_head, ATOMIC_ORDER_ACQUIRE);
+    do {
+        buffer->next = head;
+    } while (!atomic_compare_exchange_ptr(&state.buffers_head, &head, buffer,
+                                          ATOMIC_ORDER_RELEASE, ATOMIC_ORDER_ACQUIRE));
+    thread_buffer = buffer;
+    thread_buffer_session = atomic_load_u32(&state.session, ATOMIC_ORDER_ACQUIRE);
+    return buffer;
+}
+
+//место в буфере потока под запись размера size
+static u8* log_binary_reserve(log_thread_buffer* buffer, u32 size) {
+    if (buffer->used + size > LOG_BINARY_THREAD_BUFFER_SIZE) {
+        log_binary_flush_buffer(buffer);
+    }
+    u8* at = buffer->data + buffer->used;
+    buffer->used += size;
+    return at;
+}
+
+//размер записи формата
+static u32 log_binary_format_record_size(const log_binary_format* parsed) {
+    return (u32)(1 + 4 + 1 + 2 + strlen(parsed->format) + 1 + parsed->arg_count);
+}
+
+//кодирует запись формата id в at
+static void log_binary_encode_format(u8* at, u32 id) {
+    const log_binary_format* parsed = &state.formats[id];
+    u16 length = (u16)strlen(parsed->format);
+    *at++ = LOG_BINARY_RECORD_FORMAT;
+    memcpy(at, &id, 4);
+    at += 4;
+    *at++ = parsed->level;
+    memcpy(at, &length, 2);
+    at += 2;
+    memcpy(at, parsed->format, length);
+    at += length;
+    *at++ = parsed->arg_count;
+    memcpy(at, parsed->arg_types, parsed->arg_count);
+}
+
+//регистрирует формат места вызова; возвращает идентификатор
+static u32 log_binary_register(atomic_u32* format_id, log_level level, const char* format) {
+    // Разбираем формат один раз
+    log_binary_format parsed;
+    parsed.format = format;
+    parsed.level = (u8)level;
+    parsed.arg_count = 0;
+    log_binary_spec spec;
+    const char* cursor = format;
+    i32 result;
+    while ((result = log_binary_next_spec(cursor, &spec)) == 1) {
+        if (parsed.arg_count + spec.star_count + 1 > LOG_BINARY_MAX_ARGS) {
+            result = -1;
+            break;
+        }
+        for (u8 i = 0; i < spec.star_count; ++i) {
+            parsed.arg_precisions[parsed.arg_count] = LOG_BINARY_PRECISION_NONE;
+            parsed.arg_types[parsed.arg_count++] = LOG_ARG_I32;
+        }
+        parsed.arg_precisions[parsed.arg_count] = spec.precision;
+        parsed.arg_types[parsed.arg_count++] = spec.type;
+        cursor = spec.end;
+    }
+
+    u32 id = LOG_BINARY_FORMAT_UNSUPPORTED;
+    u64 length = strlen(format);
+    if (result == 0 && length <= 0xFFFF) {
+        id = atomic_fetch_add_u32(&state.next_format_id, 1, ATOMIC_ORDER_RELAXED);
+        if (id >= LOG_BINARY_MAX_FORMATS) {
+            id = LOG_BINARY_FORMAT_UNSUPPORTED;
+        } else {
+            state.formats[id] = parsed;
+        }
+    }
+
+    // Идентификатор публикуется после заполнения formats[id]. Если другой
+    // поток успел раньше, используем его идентификатор
+    u32 expected = 0;
+    u32 stored = id == LOG_BINARY_FORMAT_UNSUPPORTED ? id : id + 1;
+    if (!atomic_compare_exchange_u32(format_id, &expected, stored, ATOMIC_ORDER_RELEASE, ATOMIC_ORDER_ACQUIRE)) {
+        return expected == LOG_BINARY_FORMAT_UNSUPPORTED ? expected : expected - 1;
+    }
+    if (id == LOG_BINARY_FORMAT_UNSUPPORTED) {
+        return id;
+    }
+
+    // Запись формата идёт в буфер этого же потока
+    log_thread_buffer* buffer = log_binary_get_buffer();
+    log_binary_encode_format(log_binary_reserve(buffer, log_binary_format_record_size(&parsed)), id);
+    return id;
+}
+
+b8 logger_binary_begin(const char* path) {
+    if (atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE)) {
+        KWARN("logger_binary_begin - binary log is already active.");
+        return FALSE;
+    }
+    if (!filesystem_open(path, FILE_MODE_WRITE, TRUE, &state.file)) {
+        return FALSE;
+    }
+    log_binary_header header;
+    header.magic = LOG_BINARY_MAGIC;
+    header.version = LOG_BINARY_VERSION;
+    header.reserved = 0;
+    u64 written = 0;
+    if (!filesystem_write(&state.file, sizeof(header), &header, &written)) {
+        filesystem_close(&state.file);
+        return FALSE;
+    }
+
+    // Места вызова, зарегистрированные в прошлых сеансах, больше не пишут
+    // свои форматы - повторяем их в начале нового файла
+    u32 format_count = atomic_load_u32(&state.next_format_id, ATOMIC_ORDER_ACQUIRE);
+    if (format_count > LOG_BINARY_MAX_FORMATS) {
+        format_count = LOG_BINARY_MAX_FORMATS;
+    }
+    for (u32 id = 0; id < format_count; ++id) {
+        if (state.formats[id].format) {
+            u8 record[1 + 4 + 1 + 2 + 0xFFFF + 1 + LOG_BINARY_MAX_ARGS];
+            log_binary_encode_format(record, id);
+            filesystem_write(&state.file, log_binary_format_record_size(&state.formats[id]), record, &written);
+        }
+    }
+
+    atomic_store_u32(&state.active, TRUE, ATOMIC_ORDER_RELEASE);
+    KINFO("Binary logging of KDEBUG/KTRACE to '%s'.", path);
+    return TRUE;
+}
+
+void logger_binary_flush_thread() {
+    if (atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE) && log_binary_has_buffer()) {
+        log_binary_flush_buffer(thread_buffer);
+    }
+}
+
+void logger_binary_end() {
+    if (!atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE)) {
+        return;
+    }
+    atomic_store_u32(&state.active, FALSE, ATOMIC_ORDER_RELEASE);
+    // Указатели на буферы в TLS других потоков становятся недействительными
+    atomic_fetch_add_u32(&state.session, 1, ATOMIC_ORDER_RELEASE);
+
+    // Дописываем и освобождаем буферы всех потоков
+    log_thread_buffer* buffer = atomic_exchange_ptr(&state.buffers_head, 0, ATOMIC_ORDER_ACQ_REL);
+    while (buffer) {
+        log_thread_buffer* next = buffer->next;
+        log_binary_flush_buffer(buffer);
+        kfree(buffer->data, LOG_BINARY_THREAD_BUFFER_SIZE, MEMORY_TAG_ARRAY);
+        kfree(buffer, sizeof(log_thread_buffer), MEMORY_TAG_ARRAY);
+        buffer = next;
+    }
+    // Буфер этого потока освобождён вместе с остальными
+    thread_buffer = 0;
+    filesystem_close(&state.file);
+}
+
+void log_binary(atomic_u32* format_id, log_level level, const char* format, ...) {
+    __builtin_va_list args;
+
+    if (!atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE)) {
+#if KRELEASE == 1
+        // В релизе текстовой трассировки нет: без двоичного лога - ничего
+        return;
+#else
+        va_start(args, format);
+        log_output_va(level, format, args);
+        va_end(args);
+        return;
+#endif
+    }
+
+    u32 id = atomic_load_u32(format_id, ATOMIC_ORDER_ACQUIRE);
+    if (id == 0) {
+        id = log_binary_register(format_id, level, format);
+    } else if (id != LOG_BINARY_FORMAT_UNSUPPORTED) {
+        id--;
+    }
+    if (id == LOG_BINARY_FORMAT_UNSUPPORTED) {
+        va_start(args, format);
+        log_output_va(level, format, args);
+        va_end(args);
+        return;
+    }
+
+    // Собираем аргументы во временный буфер по типам из формата
+    const log_binary_format* parsed = &state.formats[id];
+    u8 payload[LOG_BINARY_MAX_ARGS * (2 + LOG_BINARY_MAX_STRING)];
+    u32 payload_size = 0;
+    // Последний i32: точность '*' стоит сразу перед своей строкой
+    i32 last_i32 = 0;
+    va_start(args, format);
+    for (u8 i = 0; i < parsed->arg_count; ++i) {
+        switch (parsed->arg_types[i]) {
+            case LOG_ARG_I32: {
+                i32 value = va_arg(args, i32);
+                memcpy(payload + payload_size, &value, 4);
+                payload_size += 4;
+                last_i32 = value;
+            } break;
+            case LOG_ARG_I64: {
+                i64 value = va_arg(args, i64);
+                memcpy(payload + payload_size, &value, 8);
+                payload_size += 8;
+            } break;
+            case LOG_ARG_F64: {
+                f64 value = va_arg(args, f64);
+                memcpy(payload + payload_size, &value, 8);
+                payload_size += 8;
+            } break;
+            case LOG_ARG_PTR: {
+                u64 value = (u64)va_arg(args, void*);
+                memcpy(payload + payload_size, &value, 8);
+                payload_size += 8;
+            } break;
+            case LOG_ARG_STR: {
+                // Строки копируются по значению: указатель к моменту
+                // декодирования ничего не значит
+                const char* value = va_arg(args, const char*);
+                if (!value) {
+                    value = "(null)";
+                }
+                // Читаем не дальше точности (отрицательная '*' - как без неё)
+                // и не больше LOG_BINARY_MAX_STRING байт
+                i32 precision = parsed->arg_precisions[i];
+                if (precision == LOG_BINARY_PRECISION_STAR) {
+                    precision = last_i32 < 0 ? LOG_BINARY_PRECISION_NONE : last_i32;
+                }
+                u64 limit = LOG_BINARY_MAX_STRING;
+                if (precision >= 0 && (u64)precision < limit) {
+                    limit = (u64)precision;
+                }
+                u16 length16 = (u16)strnlen(value, limit);
+                memcpy(payload + payload_size, &length16, 2);
+                memcpy(payload + payload_size + 2, value, length16);
+                payload_size += 2 + length16;
+            } break;
+        }
+    }
+    va_end(args);
+
+    log_thread_buffer* buffer = log_binary_get_buffer();
+    u8* at = log_binary_reserve(buffer, LOG_BINARY_MESSAGE_HEADER_SIZE + payload_size);
+    u64 timestamp = (u64)(platform_get_absolute_time() * 1000000000.0);
+    u16 payload_size16 = (u16)payload_size;
+    *at++ = LOG_BINARY_RECORD_MESSAGE;
+    memcpy(at, &id, 4);
+    memcpy(at + 4, &buffer->thread_index, 2);
+    memcpy(at + 6, &timestamp, 8);
+    memcpy(at + 14, &payload_size16, 2);
+    memcpy(at + 16, payload, payload_size);
+}
@@ -0,0 +1,198 @@
+/*
+
+   Формат файла двоичного лога (KDEBUG/KTRACE в двоичном режиме).
+   Общий для движка и утилиты tools/log_decoder.
+
+   Файл: заголовок log_binary_header, затем поток записей. Все числа -
+   little-endian, записи не выровнены (читать через memcpy).
+
+   Запись формата (LOG_BINARY_RECORD_FORMAT):
+     u8  kind
+     u32 format_id
+     u8  level
+     u16 length
+     char format[length]          - строка формата без завершающего нуля
+     u8  arg_count
+     u8  arg_types[arg_count]     - log_arg_type каждого аргумента по порядку
+                                    (размеры long и т.п. - как у писавшей сборки)
+
+   Запись сообщения (LOG_BINARY_RECORD_MESSAGE):
+     u8  kind
+     u32 format_id
+     u16 thread_index
+     u64 timestamp_ns             - монотонное время платформы, наносекунды
+     u16 payload_size
+     u8  payload[payload_size]    - аргументы подряд, по типам из формата:
+                                    LOG_ARG_I32 - 4 байта, LOG_ARG_I64,
+                                    LOG_ARG_F64, LOG_ARG_PTR - 8 байт,
+                                    LOG_ARG_STR - u16 длина + байты
+
+   Потоки пишут записи своими буферами, поэтому запись формата может
+   оказаться в файле позже первого сообщения с ним: декодер сначала
+   собирает все форматы, затем разбирает сообщения.
+
+*/
+
+#pragma once
+
+#include "defines.h"
+
+// Сигнатура файла ("KBLG") и версия формата
+#define LOG_BINARY_MAGIC 0x474C424B
+#define LOG_BINARY_VERSION 1
+
+// Ограничения места вызова
+#define LOG_BINARY_MAX_ARGS 16
+#define LOG_BINARY_MAX_STRING 256
+
+typedef struct log_binary_header {
+    u32 magic;    // LOG_BINARY_MAGIC
+    u16 version;  // LOG_BINARY_VERSION
+    u16 reserved;
+} log_binary_header;
+
+typedef enum log_binary_record_kind {
+    LOG_BINARY_RECORD_FORMAT = 1,
+    LOG_BINARY_RECORD_MESSAGE = 2
+} log_binary_record_kind;
+
+// Тип аргумента в записи сообщения
+typedef enum log_arg_type {
+    LOG_ARG_I32 = 1,
+    LOG_ARG_I64,
+    LOG_ARG_F64,
+    LOG_ARG_PTR,
+    LOG_ARG_STR
+} log_arg_type;
+
+// Размер заголовка записи сообщения (до payload)
+#define LOG_BINARY_MESSAGE_HEADER_SIZE (1 + 4 + 2 + 8 + 2)
+
+// Точность спецификатора: не задана / задаётся аргументом ('*')
+#define LOG_BINARY_PRECISION_NONE -1
+#define LOG_BINARY_PRECISION_STAR -2
+
+/*
+ * Спецификатор преобразования в строке формата.
+ */
+typedef struct log_binary_spec {
+    const char* start;  // указывает на '%'
+    const char* end;    // за символом преобразования
+    u8 star_count;      // аргументов-звёздочек (ширина/точность), каждый - i32
+    i32 precision;      // число, LOG_BINARY_PRECISION_NONE или _STAR
+    u8 type;            // log_arg_type значения
+    char conversion;    // символ преобразования ('d', 's', ...)
+} log_binary_spec;
+
+/*
+ * Ищет следующий спецификатор, начиная с p ("%%" пропускается).
+ *
+ * Возвращает:
+ *   1 - найден, out_spec заполнен
+ *   0 - строка закончилась
+ *  -1 - спецификатор не поддерживается (%n, %ls, %Lf, ...)
+ */
+static inline i32 log_binary_next_spec(const char* p, log_binary_spec* out_spec) {
+    for (; *p; ++p) {
+        if (*p != '%') {
+            continue;
+        }
+        if (p[1] == '%') {
+            ++p;
+            continue;
+        }
+        out_spec->start = p;
+        out_spec->star_count = 0;
+        out_spec->precision = LOG_BINARY_PRECISION_NONE;
+        ++p;
+
+        // Флаги
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'') {
+            ++p;
+        }
+        // Ширина
+        if (*p == '*') {
+            out_spec->star_count++;
+            ++p;
+        } else {
+            while (*p >= '0' && *p <= '9') {
+                ++p;
+            }
+        }
+        // Точность
+        if (*p == '.') {
+            ++p;
+            if (*p == '*') {
+                out_spec->star_count++;
+                out_spec->precision = LOG_BINARY_PRECISION_STAR;
+                ++p;
+            } else {
+                // "%.s" - точность 0
+                out_spec->precision = 0;
+                while (*p >= '0' && *p <= '9') {
+                    if (out_spec->precision < 0xFFFFFF) {
+                        out_spec->precision = out_spec->precision * 10 + (*p - '0');
+                    }
+                    ++p;
+                }
+            }
+        }
+        // Модификатор длины
+        b8 wide = FALSE;
+        b8 long_double = FALSE;
+        switch (*p) {
+            case 'h':
+                ++p;
+                if (*p == 'h') {
+                    ++p;
+                }
+                break;
+            case 'l':
+                ++p;
+                if (*p == 'l') {
+                    ++p;
+                    wide = TRUE;
+                } else {
+                    wide = sizeof(long) == 8;
+                    if (*p == 's' || *p == 'c') {
+                        return -1;  // широкие символы
+                    }
+                }
+                break;
+            case 'j':
+            case 'z':
+            case 't':
+                ++p;
+                wide = sizeof(void*) == 8;
+                break;
+            case 'L':
+                ++p;
+                long_double = TRUE;
+                break;
+        }
+
+        out_spec->conversion = *p;
+        switch (*p) {
+            case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                out_spec->type = wide ? LOG_ARG_I64 : LOG_ARG_I32;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                if (long_double) {
+                    return -1;
+                }
+                out_spec->type = LOG_ARG_F64;
+                break;
+            case 's':
+                out_spec->type = LOG_ARG_STR;
+                break;
+            case 'p':
+                out_spec->type = LOG_ARG_PTR;
+                break;
+            default:
+                return -1;
+        }
+        out_spec->end = p + 1;
+        return 1;
+    }
+    return 0;
+}
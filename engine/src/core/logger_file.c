@@ -0,0 +1,238 @@
+/*
+
+   Файловый вывод лога.
+
+   Сообщения копируются в большой буфер и уходят в файл одним блоком:
+   при заполнении буфера, когда поток записи логгера простаивает, после
+   ERROR/FATAL и в logger_flush. При превышении порога размера файл
+   ротируется: path -> path.1 -> ... -> path.N, самый старый удаляется.
+
+   Дополнительно каждый уровень может писаться в свой файл (path.error,
+   path.warn, ...), с той же ротацией.
+
+*/
+
+#include "core/logger.h"
+#include "core/kmemory.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+#include "platform/atomic.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Буфер основного файла и файлов уровней
+#define LOG_FILE_BUFFER_SIZE (1024 * 1024)
+#define LOG_FILE_LEVEL_BUFFER_SIZE (64 * 1024)
+
+// Максимальная длина пути (с суффиксами уровня и номера ротации)
+#define LOG_FILE_PATH_MAX 512
+
+// Файл лога с буфером
+typedef struct log_file_sink {
+  file_handle file;
+  char path[LOG_FILE_PATH_MAX];
+  char *buffer;
+  u64 capacity;
+  u64 used;
+  u64 file_size;  // байт в текущем файле, включая буфер
+} log_file_sink;
+
+typedef struct log_file_state {
+  atomic_u32 active;  // читается без блокировки
+  platform_mutex lock;  // в синхронном режиме пишут разные потоки
+  u64 max_size;
+  u32 max_files;
+  b8 per_level;
+  log_file_sink main;
+  log_file_sink levels[6];
+} log_file_state;
+
+static log_file_state state;
+
+// Поток уже внутри файлового вывода: сообщения об ошибках самого вывода
+// (например, из filesystem_open при ротации) в файл не пишутся
+static KTHREAD_LOCAL b8 inside_sink = FALSE;
+
+static const char *level_suffixes[6] = {"fatal", "error", "warn", "info", "debug", "trace"};
+
+static void log_file_lock() {
+  platform_mutex_lock(&state.lock);
+  inside_sink = TRUE;
+}
+
+static void log_file_unlock() {
+  inside_sink = FALSE;
+  platform_mutex_unlock(&state.lock);
+}
+
+//открывает файл вывода и выделяет ему буфер
+static b8 sink_open(log_file_sink *sink, const char *path, u64 capacity) {
+  if (strlen(path) + 8 >= LOG_FILE_PATH_MAX) {
+    KERROR("logger_file_begin - log path is too long: '%s'.", path);
+    return FALSE;
+  }
+  strcpy(sink->path, path);
+  if (!filesystem_open(sink->path, FILE_MODE_WRITE, TRUE, &sink->file)) {
+    return FALSE;
+  }
+  sink->buffer = kallocate_ex(capacity, 0, MEMORY_TAG_ARRAY, KALLOCATE_FLAG_NO_ZERO);
+  sink->capacity = capacity;
+  sink->used = 0;
+  sink->file_size = 0;
+  return TRUE;
+}
+
+//отдаёт буфер в файл
+static void sink_flush(log_file_sink *sink) {
+  if (sink->used > 0) {
+    u64 written = 0;
+    filesystem_write(&sink->file, sink->used, sink->buffer, &written);
+    sink->used = 0;
+  }
+}
+
+//дописывает буфер, закрывает файл и освобождает буфер
+static void sink_close(log_file_sink *sink) {
+  if (!sink->buffer) {
+    return;
+  }
+  sink_flush(sink);
+  filesystem_close(&sink->file);
+  kfree(sink->buffer, sink->capacity, MEMORY_TAG_ARRAY);
+  sink->buffer = 0;
+}
+
+//ротация: path.N удаляется, path.i -> path.(i+1), path -> path.1, новый path
+static void sink_rotate(log_file_sink *sink) {
+  sink_flush(sink);
+  filesystem_close(&sink->file);
+
+  if (state.max_files > 0) {
+    // Запас под суффикс номера
+    char from[LOG_FILE_PATH_MAX + 16];
+    char to[LOG_FILE_PATH_MAX + 16];
+    snprintf(to, sizeof(to), "%s.%u", sink->path, state.max_files);
+    filesystem_delete(to);
+    for (u32 i = state.max_files - 1; i >= 1; --i) {
+      snprintf(from, sizeof(from), "%s.%u", sink->path, i);
+      snprintf(to, sizeof(to), "%s.%u", sink->path, i + 1);
+      filesystem_rename(from, to);
+    }
+    snprintf(to, sizeof(to), "%s.1", sink->path);
+    filesystem_rename(sink->path, to);
+  }
+
+  // Без хранимых копий файл просто начинается заново
+  filesystem_open(sink->path, FILE_MODE_WRITE, TRUE, &sink->file);
+  sink->file_size = 0;
+}
+
+static void sink_write(log_file_sink *sink, const char *text, u64 length) {
+  if (state.max_size && sink->file_size > 0 && sink->file_size + length > state.max_size) {
+    sink_rotate(sink);
+  }
+  if (!sink->file.is_valid) {
+    return;
+  }
+  if (sink->used + length > sink->capacity) {
+    sink_flush(sink);
+  }
+  if (length > sink->capacity) {
+    // Сообщение больше буфера - пишем напрямую
+    u64 written = 0;
+    filesystem_write(&sink->file, length, text, &written);
+  } else {
+    memcpy(sink->buffer + sink->used, text, length);
+    sink->used += length;
+  }
+  sink->file_size += length;
+}
+
+b8 logger_file_begin(const log_file_config *config) {
+  if (atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE)) {
+    KWARN("logger_file_begin - log file is already open.");
+    return FALSE;
+  }
+  if (!config || !config->path) {
+    KERROR("logger_file_begin - path is required.");
+    return FALSE;
+  }
+  state.max_size = config->max_size;
+  state.max_files = config->max_files;
+  state.per_level = config->per_level_files;
+
+  if (!sink_open(&state.main, config->path, LOG_FILE_BUFFER_SIZE)) {
+    return FALSE;
+  }
+  if (state.per_level) {
+    char path[LOG_FILE_PATH_MAX + 16];
+    for (u32 i = 0; i < 6; ++i) {
+      snprintf(path, sizeof(path), "%s.%s", config->path, level_suffixes[i]);
+      if (!sink_open(&state.levels[i], path, LOG_FILE_LEVEL_BUFFER_SIZE)) {
+        for (u32 j = 0; j < i; ++j) {
+          sink_close(&state.levels[j]);
+        }
+        sink_close(&state.main);
+        return FALSE;
+      }
+    }
+  }
+
+  atomic_store_u32(&state.active, TRUE, ATOMIC_ORDER_RELEASE);
+  KINFO("Logging to file '%s'.", config->path);
+  return TRUE;
+}
+
+void logger_file_end() {
+  if (!atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE)) {
+    return;
+  }
+  log_file_lock();
+  atomic_store_u32(&state.active, FALSE, ATOMIC_ORDER_RELEASE);
+  sink_close(&state.main);
+  if (state.per_level) {
+    for (u32 i = 0; i < 6; ++i) {
+      sink_close(&state.levels[i]);
+    }
+  }
+  log_file_unlock();
+}
+
+void log_file_write(log_level level, const char *text, u64 length) {
+  if (!atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE) || inside_sink) {
+    return;
+  }
+  log_file_lock();
+  // Файл мог закрыться, пока ждали блокировку
+  if (atomic_load_u32(&state.active, ATOMIC_ORDER_RELAXED)) {
+    sink_write(&state.main, text, length);
+    if (state.per_level) {
+      sink_write(&state.levels[level], text, length);
+    }
+    // Ошибки должны оказаться в файле, даже если процесс сейчас упадёт
+    if (level <= LOG_LEVEL_ERROR) {
+      sink_flush(&state.main);
+      if (state.per_level) {
+        sink_flush(&state.levels[level]);
+      }
+    }
+  }
+  log_file_unlock();
+}
+
+void log_file_flush() {
+  if (!atomic_load_u32(&state.active, ATOMIC_ORDER_ACQUIRE) || inside_sink) {
+    return;
+  }
+  log_file_lock();
+  if (atomic_load_u32(&state.active, ATOMIC_ORDER_RELAXED)) {
+    sink_flush(&state.main);
+    if (state.per_level) {
+      for (u32 i = 0; i < 6; ++i) {
+        sink_flush(&state.levels[i]);
+      }
+    }
+  }
+  log_file_unlock();
+}
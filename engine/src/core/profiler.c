@@ -0,0 +1,276 @@
+#include "core/profiler.h"
+
+#include "core/logger.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// Зон в кольце одного потока (степень двойки): 32768 * 24 = 768 КиБ
+#define PROFILER_THREAD_ZONES 32768
+
+// Глубина вложенности открытых зон потока
+#define PROFILER_MAX_DEPTH 64
+
+// Буфер записи файла трассы
+#define PROFILER_WRITE_BUFFER_SIZE (64 * 1024)
+
+atomic_u32 profiler_active = {FALSE};
+
+#if PROFILER_ENABLED == 1
+
+// Завершённая зона
+typedef struct profiler_zone {
+    const char* name;
+    u64 start_ns;
+    u64 duration_ns;
+} profiler_zone;
+
+// Открытая зона (стек потока)
+typedef struct profiler_open_zone {
+    const char* name;
+    u64 start_ns;
+} profiler_open_zone;
+
+/*
+ * Буфер потока. Пишет только сам поток; профилировщик читает кольцо при
+ * выгрузке. Буферы связаны в список и живут до конца процесса.
+ */
+typedef struct profiler_thread {
+    profiler_zone zones[PROFILER_THREAD_ZONES];
+    atomic_u64 zone_count;  // всего записано зон (позиция в кольце - по маске)
+    profiler_open_zone stack[PROFILER_MAX_DEPTH];
+    u32 depth;       // открытых зон, включая не поместившиеся в стек
+    u32 capture;     // запись, к которой относится стек открытых зон
+    u32 thread_index;
+    const char* name;
+    struct profiler_thread* next;
+} profiler_thread;
+
+static atomic_ptr threads_head = {0};  // profiler_thread*
+static atomic_u32 next_thread_index = {0};
+static atomic_u64 capture_start_ns = {0};
+// Номер записи: растёт в profiler_start. Зоны, открытые в прошлой записи,
+// могли не закрыться (KPROFILE_END после profiler_stop ничего не делает) -
+// по смене номера стек потока сбрасывается
+static atomic_u32 capture_index = {0};
+static KTHREAD_LOCAL profiler_thread* thread_profiler = 0;
+// Имя, заданное до первой зоны потока (буфер заводится только при записи)
+static KTHREAD_LOCAL const char* thread_name = 0;
+
+static u64 profiler_now_ns() {
+    return (u64)(platform_get_absolute_time() * 1000000000.0);
+}
+
+//буфер вызывающего потока (создаётся при первой зоне). Память берётся
+//у платформы напрямую: kallocate сам размечен зоной
+static profiler_thread* profiler_get_thread() {
+    if (thread_profiler) {
+        return thread_profiler;
+    }
+    profiler_thread* thread = platform_allocate_zeroed(sizeof(profiler_thread), FALSE);
+    thread->thread_index = atomic_fetch_add_u32(&next_thread_index, 1, ATOMIC_ORDER_RELAXED);
+    thread->name = thread_name;
+    thread->capture = atomic_load_u32(&capture_index, ATOMIC_ORDER_ACQUIRE);
+
+    void* head = atomic_load_ptr(&threads_head, ATOMIC_ORDER_ACQUIRE);
+    do {
+        thread->next = head;
+    } while (!atomic_compare_exchange_ptr(&threads_head, &head, thread,
+                                          ATOMIC_ORDER_RELEASE, ATOMIC_ORDER_ACQUIRE));
+    thread_profiler = thread;
+    return thread;
+}
+
+void profiler_start() {
+    atomic_fetch_add_u32(&capture_index, 1, ATOMIC_ORDER_RELEASE);
+    atomic_store_u64(&capture_start_ns, profiler_now_ns(), ATOMIC_ORDER_RELAXED);
+    atomic_store_u32(&profiler_active, TRUE, ATOMIC_ORDER_RELEASE);
+}
+
+void profiler_stop() {
+    atomic_store_u32(&profiler_active, FALSE, ATOMIC_ORDER_RELEASE);
+}
+
+void profiler_set_thread_name(const char* name) {
+    thread_name = name;
+    if (thread_profiler) {
+        thread_profiler->name = name;
+    }
+}
+
+//стек открытых зон потока, сброшенный, если он остался от прошлой записи
+static profiler_thread* profiler_get_current_thread() {
+    profiler_thread* thread = profiler_get_thread();
+    u32 capture = atomic_load_u32(&capture_index, ATOMIC_ORDER_ACQUIRE);
+    if (thread->capture != capture) {
+        thread->capture = capture;
+        thread->depth = 0;
+    }
+    return thread;
+}
+
+void profiler_begin(const char* name) {
+    profiler_thread* thread = profiler_get_current_thread();
+    if (thread->depth < PROFILER_MAX_DEPTH) {
+        thread->stack[thread->depth].name = name;
+        thread->stack[thread->depth].start_ns = profiler_now_ns();
+    }
+    thread->depth++;
+}
+
+void profiler_end(const char* name) {
+    profiler_thread* thread = profiler_get_current_thread();
+    // Зона открыта до profiler_start (или конец без начала) - пропускаем
+    if (thread->depth == 0) {
+        return;
+    }
+    if (thread->depth > PROFILER_MAX_DEPTH) {
+        thread->depth--;
+        return;
+    }
+    // Ищем зону с этим именем. Вложенные в неё незакрытые зоны (конец
+    // пропущен) отбрасываются; конец без начала ничего не меняет
+    u32 index = thread->depth;
+    while (index > 0 && thread->stack[index - 1].name != name) {
+        index--;
+    }
+    if (index == 0) {
+        return;
+    }
+    thread->depth = index - 1;
+    profiler_open_zone* open = &thread->stack[index - 1];
+
+    // zone_count пишет только этот поток: своё значение читается relaxed
+    u64 zone_count = atomic_load_u64(&thread->zone_count, ATOMIC_ORDER_RELAXED);
+    profiler_zone* zone = &thread->zones[zone_count & (PROFILER_THREAD_ZONES - 1)];
+    zone->name = name;
+    zone->start_ns = open->start_ns;
+    zone->duration_ns = profiler_now_ns() - open->start_ns;
+    // Счётчик публикуется после записи зоны
+    atomic_store_u64(&thread->zone_count, zone_count + 1, ATOMIC_ORDER_RELEASE);
+}
+
+/*
+ * Буферизованная запись файла трассы.
+ */
+typedef struct trace_writer {
+    file_handle file;
+    char buffer[PROFILER_WRITE_BUFFER_SIZE];
+    u64 used;
+    b8 first_event;
+} trace_writer;
+
+static void trace_flush(trace_writer* writer) {
+    u64 written = 0;
+    filesystem_write(&writer->file, writer->used, writer->buffer, &written);
+    writer->used = 0;
+}
+
+//добавляет событие; строка name экранируется для JSON
+static void trace_event(trace_writer* writer, const char* format_head, const char* name, const char* format_tail, ...) {
+    // Одно событие заведомо меньше 1 КиБ
+    if (writer->used + 1024 > PROFILER_WRITE_BUFFER_SIZE) {
+        trace_flush(writer);
+    }
+    char* out = writer->buffer + writer->used;
+    u64 length = 0;
+    if (!writer->first_event) {
+        out[length++] = ',';
+    }
+    writer->first_event = FALSE;
+    out[length++] = '\n';
+
+    length += snprintf(out + length, 256, "%s", format_head);
+    for (const char* c = name; *c && length < 768; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out[length++] = '\\';
+        }
+        out[length++] = (*c >= ' ') ? *c : ' ';
+    }
+    __builtin_va_list args;
+    va_start(args, format_tail);
+    length += vsnprintf(out + length, 256, format_tail, args);
+    va_end(args);
+    writer->used += length;
+}
+
+b8 profiler_write_trace(const char* path) {
+    // Буфер записи велик для стека
+    trace_writer* writer = platform_allocate(sizeof(trace_writer), FALSE);
+    if (!filesystem_open(path, FILE_MODE_WRITE, TRUE, &writer->file)) {
+        platform_free(writer, FALSE);
+        return FALSE;
+    }
+    writer->used = 0;
+    writer->first_event = TRUE;
+    const char* header = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    u64 written = 0;
+    filesystem_write(&writer->file, strlen(header), header, &written);
+
+    u64 start_ns = atomic_load_u64(&capture_start_ns, ATOMIC_ORDER_RELAXED);
+    u64 zone_total = 0;
+    profiler_thread* thread = atomic_load_ptr(&threads_head, ATOMIC_ORDER_ACQUIRE);
+    for (; thread; thread = thread->next) {
+        char default_name[32];
+        const char* name = thread->name;
+        if (!name) {
+            snprintf(default_name, sizeof(default_name), "thread %u", thread->thread_index);
+            name = default_name;
+        }
+        trace_event(writer, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"", name,
+                    "\"},\"tid\":%u}", thread->thread_index);
+
+        // Последние PROFILER_THREAD_ZONES зон. Поток может дописывать кольцо
+        // во время выгрузки: самые старые из прочитанных зон тогда могут
+        // оказаться уже новыми - на трассу это почти не влияет
+        u64 count = atomic_load_u64(&thread->zone_count, ATOMIC_ORDER_ACQUIRE);
+        u64 first = count > PROFILER_THREAD_ZONES ? count - PROFILER_THREAD_ZONES : 0;
+        for (u64 i = first; i < count; ++i) {
+            const profiler_zone* zone = &thread->zones[i & (PROFILER_THREAD_ZONES - 1)];
+            if (zone->start_ns < start_ns) {
+                continue;
+            }
+            // Время в микросекундах от начала записи
+            trace_event(writer, "{\"name\":\"", zone->name, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        thread->thread_index, (f64)(zone->start_ns - start_ns) * 0.001, (f64)zone->duration_ns * 0.001);
+            zone_total++;
+        }
+    }
+
+    trace_flush(writer);
+    const char* footer = "\n]}\n";
+    filesystem_write(&writer->file, strlen(footer), footer, &written);
+    filesystem_close(&writer->file);
+    platform_free(writer, FALSE);
+    KINFO("Profiler trace written to '%s' (%llu zones).", path, zone_total);
+    return TRUE;
+}
+
+#else
+
+// Профилировщик выключен при сборке: управление ничего не делает
+
+void profiler_start() {
+}
+
+void profiler_stop() {
+}
+
+void profiler_set_thread_name(const char* name) {
+}
+
+void profiler_begin(const char* name) {
+}
+
+void profiler_end(const char* name) {
+}
+
+b8 profiler_write_trace(const char* path) {
+    KWARN("profiler_write_trace - profiler is compiled out (KRELEASE).");
+    return FALSE;
+}
+
+#endif
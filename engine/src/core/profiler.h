@@ -0,0 +1,75 @@
+/*
+  Профилировщик зон.
+
+  Зона - участок кода между KPROFILE_BEGIN(name) и KPROFILE_END(name),
+  name - строковый литерал (хранится указатель). Каждый поток пишет
+  завершённые зоны в свой кольцевой буфер: начало и длительность.
+  profiler_write_trace выгружает их в формате Chrome trace event (JSON),
+  который открывают chrome://tracing и Perfetto (ui.perfetto.dev).
+
+  Пока запись не начата (profiler_start), зона стоит одну проверку флага.
+  В релизной сборке (KRELEASE == 1) макросы пустые, а функции управления
+  ничего не делают.
+*/
+#pragma once
+
+#include "defines.h"
+#include "platform/atomic.h"
+
+/* Профилировщик есть только в отладочных сборках */
+#if KRELEASE == 1
+#define PROFILER_ENABLED 0
+#else
+#define PROFILER_ENABLED 1
+#endif
+
+// Идёт ли запись зон. Читается макросами напрямую (relaxed)
+KAPI extern atomic_u32 profiler_active;
+
+/*
+ * Начинает запись зон. Зоны, записанные до этого, в трассу не попадают.
+ */
+KAPI void profiler_start();
+
+/*
+ * Останавливает запись. Записанное остаётся доступным для выгрузки.
+ */
+KAPI void profiler_stop();
+
+/*
+ * Выгружает записанные зоны всех потоков в файл path (Chrome trace JSON).
+ * Можно вызывать во время записи; у каждого потока в файл попадают
+ * последние PROFILER_THREAD_ZONES зон.
+ *
+ * Возвращает:
+ *   TRUE - файл записан; FALSE - ошибка или профилировщик выключен при сборке
+ */
+KAPI b8 profiler_write_trace(const char* path);
+
+/*
+ * Имя вызывающего потока в трассе (строковый литерал).
+ */
+KAPI void profiler_set_thread_name(const char* name);
+
+// Начало и конец зоны; вызываются через макросы
+KAPI void profiler_begin(const char* name);
+KAPI void profiler_end(const char* name);
+
+#if PROFILER_ENABLED == 1
+// Начало зоны name (строковый литерал)
+#define KPROFILE_BEGIN(name)                                                   \
+  {                                                                            \
+    if (atomic_load_u32(&profiler_active, ATOMIC_ORDER_RELAXED))               \
+      profiler_begin(name);                                                    \
+  }
+// Конец зоны name. Зона, начатая до profiler_start, закрывается без записи.
+// Зоны, не закрытые до profiler_stop, отбрасываются при следующем profiler_start
+#define KPROFILE_END(name)                                                     \
+  {                                                                            \
+    if (atomic_load_u32(&profiler_active, ATOMIC_ORDER_RELAXED))               \
+      profiler_end(name);                                                      \
+  }
+#else
+#define KPROFILE_BEGIN(name)
+#define KPROFILE_END(name)
+#endif
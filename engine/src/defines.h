@@ -112,3 +112,10 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #define KAPI
 
 #endif
+
+// Переменная, своя для каждого потока (thread-local storage)
+#if defined(_MSC_VER)
+#define KTHREAD_LOCAL __declspec(thread)
+#else
+#define KTHREAD_LOCAL _Thread_local
+#endif
@@ -11,20 +11,66 @@
 #include "game_types.h"
 #include "core/kmemory.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 //Внешне определенная функция для создания игры.
 extern b8 create_game(game* out_game);
 
 
-int main(void) {
+int main(int argc, char** argv) {
     initialize_memory();
 
     // Создание экземпляра игры
+    // Обнуляем, чтобы поля конфигурации, не заданные игрой, были нулевыми
     game game_inst;
+    kzero_memory(&game_inst, sizeof(game));
     if (!create_game(&game_inst)) {
         KFATAL("Не удалось создать игру!");
         return -1;
     }
 
+    // Параметры командной строки перекрывают конфигурацию игры:
+    //   --record <файл>  записать ввод
+    //   --replay <файл>  воспроизвести ввод
+    //   --fast           воспроизводить без ожидания реального времени
+    //   --binary-log <файл>  писать KDEBUG/KTRACE в двоичный лог
+    //   --log-file <файл>    писать лог ещё и в файл
+    //   --log-level <уровень>  fatal, error, warn, info, debug или trace
+    //   --fps <n>        целевая частота кадров (0 - без ограничения)
+    //   --frame-stats <секунды>  выводить сводку хронометража кадров
+    //   --profile <файл>  записать трассу профилировщика (chrome://tracing)
+    //   --jobs <n>       рабочих потоков системы задач (0 - по числу ядер)
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            game_inst.app_config.input_record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            game_inst.app_config.input_replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--fast") == 0) {
+            game_inst.app_config.replay_unthrottled = TRUE;
+        } else if (strcmp(argv[i], "--binary-log") == 0 && i + 1 < argc) {
+            game_inst.app_config.binary_log_path = argv[++i];
+        } else if (strcmp(argv[i], "--log-file") == 0 && i + 1 < argc) {
+            game_inst.app_config.log_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            game_inst.app_config.profile_trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--frame-stats") == 0 && i + 1 < argc) {
+            game_inst.app_config.frame_stats_log_interval = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            game_inst.app_config.job_worker_count = (u32)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            game_inst.app_config.target_frame_rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            static const char* level_names[6] = {"fatal", "error", "warn", "info", "debug", "trace"};
+            const char* name = argv[++i];
+            for (u32 level = 0; level < 6; ++level) {
+                if (strcmp(name, level_names[level]) == 0) {
+                    logger_set_level((log_level)level);
+                }
+            }
+        }
+    }
+
     // Валидация указателей на функции
     
    if (!game_inst.initialize) KERROR("initialize is NULL");
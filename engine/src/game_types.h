@@ -13,7 +13,10 @@
     application_config app_config;  // Конфигурация приложения
     b8 (*initialize)(struct game*); // Указатель на функцию инициализации
     b8 (*update)(struct game*, f32); // Указатель на функцию обновления
-    b8 (*render)(struct game*, f32); // Указатель на функцию рендеринга
+    // Указатель на функцию рендеринга: дельта кадра и доля шага симуляции
+    // (0..1) для интерполяции между двумя последними состояниями при
+    // fixed_update; без fixed_update всегда 1
+    b8 (*render)(struct game*, f32, f32);
     void (*on_resize)(struct game*, u32, u32); // Обработчик изменения размера
     void* state; // Указатель на состояние игры (кастомные данные)
 } game;
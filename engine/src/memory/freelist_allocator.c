@@ -0,0 +1,266 @@
+#include "memory/freelist_allocator.h"
+
+#include "core/logger.h"
+
+/*
+ * Свободный участок. Хранится в начале самого участка.
+ */
+typedef struct freelist_node {
+    u64 size;                    // размер участка в байтах
+    struct freelist_node* next;  // следующий участок (по адресу)
+} freelist_node;
+
+/*
+ * Заголовок выделенного блока. Лежит прямо перед указателем,
+ * который получает пользователь.
+ */
+typedef struct freelist_header {
+    u64 size;    // размер всего участка (заголовок + выравнивание + данные)
+    u64 offset;  // расстояние от начала участка до пользовательского указателя
+} freelist_header;
+
+// Все границы участков кратны 16 байт
+#define FREELIST_GRANULARITY 16
+// Остаток меньше этого не отделяется в новый участок, а отдаётся целиком
+#define FREELIST_MIN_SPLIT (sizeof(freelist_header) + FREELIST_GRANULARITY)
+
+STATIC_ASSERT(sizeof(freelist_node) <= FREELIST_GRANULARITY, "freelist_node must fit into the smallest block.");
+STATIC_ASSERT(sizeof(freelist_header) == FREELIST_GRANULARITY, "freelist_header must keep blocks 16-byte aligned.");
+
+//округление вверх до кратного alignment (степень двойки)
+static inline u64 align_up(u64 value, u64 alignment) {
+    return (value + (alignment - 1)) & ~(alignment - 1);
+}
+
+/*
+ * Создаёт аллокатор: вся область - один свободный участок.
+ */
+b8 freelist_allocator_create(u64 total_size, void* memory, memory_tag tag, freelist_fit_policy policy, freelist_allocator* out_allocator) {
+    if (!out_allocator) {
+        return FALSE;
+    }
+    // Размер округляем вниз, чтобы хвост не нарушал кратность 16
+    total_size &= ~(u64)(FREELIST_GRANULARITY - 1);
+    if (total_size < FREELIST_MIN_SPLIT) {
+        KERROR("freelist_allocator_create - total_size %llu is too small.", total_size);
+        return FALSE;
+    }
+    if ((u64)memory & (FREELIST_GRANULARITY - 1)) {
+        KERROR("freelist_allocator_create - memory must be aligned to %d bytes.", FREELIST_GRANULARITY);
+        return FALSE;
+    }
+
+    out_allocator->total_size = total_size;
+    out_allocator->tag = tag;
+    out_allocator->policy = policy;
+    out_allocator->owns_memory = memory == 0;
+    out_allocator->memory = memory ? memory : kallocate_ex(total_size, 0, tag, KALLOCATE_FLAG_NO_ZERO);
+    out_allocator->free_space = total_size;
+    out_allocator->allocation_count = 0;
+
+    out_allocator->head = (freelist_node*)out_allocator->memory;
+    out_allocator->head->size = total_size;
+    out_allocator->head->next = 0;
+    return TRUE;
+}
+
+/*
+ * Уничтожает аллокатор.
+ */
+void freelist_allocator_destroy(freelist_allocator* allocator) {
+    if (!allocator) {
+        return;
+    }
+    if (allocator->allocation_count > 0) {
+        KWARN("freelist_allocator_destroy - %llu allocations are still alive.", allocator->allocation_count);
+    }
+    if (allocator->owns_memory && allocator->memory) {
+        kfree(allocator->memory, allocator->total_size, allocator->tag);
+    }
+    kzero_memory(allocator, sizeof(freelist_allocator));
+}
+
+void* freelist_allocator_allocate(freelist_allocator* allocator, u64 size) {
+    return freelist_allocator_allocate_aligned(allocator, size, FREELIST_GRANULARITY);
+}
+
+/*
+ * Сколько байт участка node займёт выделение size с выравниванием alignment.
+ */
+static inline u64 freelist_required_size(freelist_node* node, u64 size, u64 alignment) {
+    u64 start = (u64)node;
+    u64 user = align_up(start + sizeof(freelist_header), alignment);
+    return align_up(user + size, FREELIST_GRANULARITY) - start;
+}
+
+/*
+ * Ищет участок по выбранной стратегии, при необходимости делит его
+ * и записывает заголовок перед пользовательским указателем.
+ */
+void* freelist_allocator_allocate_aligned(freelist_allocator* allocator, u64 size, u64 alignment) {
+    if (!allocator || !allocator->memory || size == 0) {
+        return 0;
+    }
+    if (alignment & (alignment - 1)) {
+        KERROR("freelist_allocator_allocate_aligned - alignment %llu is not a power of two.", alignment);
+        return 0;
+    }
+    if (alignment < FREELIST_GRANULARITY) {
+        alignment = FREELIST_GRANULARITY;
+    }
+
+    freelist_node* prev = 0;
+    freelist_node* node = allocator->head;
+    freelist_node* found = 0;
+    freelist_node* found_prev = 0;
+    u64 found_required = 0;
+    while (node) {
+        u64 required = freelist_required_size(node, size, alignment);
+        if (required <= node->size) {
+            if (!found || node->size < found->size) {
+                found = node;
+                found_prev = prev;
+                found_required = required;
+            }
+            // Первый подходящий или точное совпадение - дальше искать незачем
+            if (allocator->policy == FREELIST_FIT_FIRST || node->size == required) {
+                break;
+            }
+        }
+        prev = node;
+        node = node->next;
+    }
+
+    if (!found) {
+        KERROR("freelist_allocator_allocate - no block large enough for %lluB (free: %lluB, largest: %lluB).",
+               size, allocator->free_space, freelist_allocator_largest_free_block(allocator));
+        return 0;
+    }
+
+    // Делим участок, если остаток достаточно велик, иначе отдаём целиком
+    u64 block_size = found->size;
+    freelist_node* replacement = found->next;
+    if (block_size - found_required >= FREELIST_MIN_SPLIT) {
+        freelist_node* rest = (freelist_node*)((u8*)found + found_required);
+        rest->size = block_size - found_required;
+        rest->next = found->next;
+        replacement = rest;
+        block_size = found_required;
+    }
+    if (found_prev) {
+        found_prev->next = replacement;
+    } else {
+        allocator->head = replacement;
+    }
+
+    u64 start = (u64)found;
+    u64 user = align_up(start + sizeof(freelist_header), alignment);
+    freelist_header* header = (freelist_header*)(user - sizeof(freelist_header));
+    header->size = block_size;
+    header->offset = user - start;
+
+    allocator->free_space -= block_size;
+    allocator->allocation_count++;
+    return (void*)user;
+}
+
+/*
+ * Возвращает участок в список (по адресу) и склеивает его с соседями.
+ *
+ * Заголовку освобождённого блока верить нельзя: при смещении 16 поле offset
+ * делит слово с freelist_node.next. Поэтому сначала по списку проверяется,
+ * что указатель не лежит в свободном участке (повторное освобождение), и
+ * только потом заголовок - что блок целиком помещается между соседними
+ * свободными участками. До этих проверок ничего не записывается.
+ */
+void freelist_allocator_free(freelist_allocator* allocator, void* block) {
+    if (!allocator || !block) {
+        return;
+    }
+    u8* memory_start = (u8*)allocator->memory;
+    if ((u8*)block < memory_start || (u8*)block >= memory_start + allocator->total_size) {
+        KERROR("freelist_allocator_free - block %p does not belong to this allocator.", block);
+        return;
+    }
+
+    // Соседние свободные участки: prev < block < node
+    freelist_node* prev = 0;
+    freelist_node* node = allocator->head;
+    while (node && (u8*)node <= (u8*)block) {
+        prev = node;
+        node = node->next;
+    }
+    u8* gap_start = prev ? (u8*)prev + prev->size : memory_start;
+    u8* gap_end = node ? (u8*)node : memory_start + allocator->total_size;
+    if ((u8*)block < gap_start) {
+        KERROR("freelist_allocator_free - double free of block %p.", block);
+        return;
+    }
+
+    freelist_header* header = (freelist_header*)((u8*)block - sizeof(freelist_header));
+    u64 block_size = header->size;
+    u64 offset = header->offset;
+    if (offset < sizeof(freelist_header) || offset > (u64)((u8*)block - gap_start) ||
+        block_size > (u64)(gap_end - ((u8*)block - offset)) || block_size < offset) {
+        KERROR("freelist_allocator_free - block %p has a corrupted header.", block);
+        return;
+    }
+    freelist_node* freed = (freelist_node*)((u8*)block - offset);
+    freed->size = block_size;
+
+    // Склейка с последующим участком
+    freed->next = node;
+    if (node && (u8*)freed + freed->size == (u8*)node) {
+        freed->size += node->size;
+        freed->next = node->next;
+    }
+
+    // Склейка с предыдущим участком
+    if (prev && (u8*)prev + prev->size == (u8*)freed) {
+        prev->size += freed->size;
+        prev->next = freed->next;
+    } else if (prev) {
+        prev->next = freed;
+    } else {
+        allocator->head = freed;
+    }
+
+    allocator->free_space += block_size;
+    allocator->allocation_count--;
+}
+
+u64 freelist_allocator_free_space(const freelist_allocator* allocator) {
+    return allocator ? allocator->free_space : 0;
+}
+
+u64 freelist_allocator_largest_free_block(const freelist_allocator* allocator) {
+    u64 largest = 0;
+    if (!allocator) {
+        return 0;
+    }
+    for (freelist_node* node = allocator->head; node; node = node->next) {
+        if (node->size > largest) {
+            largest = node->size;
+        }
+    }
+    return largest;
+}
+
+void freelist_allocator_get_stats(const freelist_allocator* allocator, freelist_allocator_stats* out_stats) {
+    if (!allocator || !out_stats) {
+        return;
+    }
+    kzero_memory(out_stats, sizeof(freelist_allocator_stats));
+    out_stats->total_size = allocator->total_size;
+    out_stats->free_space = allocator->free_space;
+    out_stats->allocation_count = allocator->allocation_count;
+    for (freelist_node* node = allocator->head; node; node = node->next) {
+        out_stats->free_block_count++;
+        if (node->size > out_stats->largest_free_block) {
+            out_stats->largest_free_block = node->size;
+        }
+    }
+    if (out_stats->free_space > 0) {
+        out_stats->fragmentation = 1.0f - (f32)out_stats->largest_free_block / (f32)out_stats->free_space;
+    }
+}
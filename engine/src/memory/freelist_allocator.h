@@ -0,0 +1,112 @@
+/*
+  Аллокатор со списком свободных блоков (free-list).
+
+  Один большой блок резервируется заранее (через kallocate с заданным тегом
+  или передаётся снаружи) и нарезается на куски произвольного размера.
+  Свободные участки хранятся в интрузивном списке, упорядоченном по адресу,
+  поэтому при освобождении соседние участки сразу склеиваются (coalescing).
+  После создания системный аллокатор больше не вызывается - подсистема
+  живёт в одной непрерывной области с предсказуемым размером.
+
+  Аллокатор не потокобезопасен.
+*/
+#pragma once
+
+#include "defines.h"
+#include "core/kmemory.h"
+
+/*
+ * Стратегия поиска свободного участка.
+ */
+typedef enum freelist_fit_policy {
+    FREELIST_FIT_FIRST,  // первый подходящий участок - быстрее
+    FREELIST_FIT_BEST    // самый маленький подходящий - меньше фрагментация
+} freelist_fit_policy;
+
+/*
+ * Статистика аллокатора.
+ */
+typedef struct freelist_allocator_stats {
+    u64 total_size;          // размер всей области
+    u64 free_space;          // суммарно свободно байт
+    u64 largest_free_block;  // самый большой непрерывный свободный участок
+    u64 free_block_count;    // количество свободных участков (фрагментов)
+    u64 allocation_count;    // количество живых выделений
+    // Фрагментация: 0 - вся свободная память одним куском,
+    // ближе к 1 - свободная память раздроблена на мелкие участки
+    f32 fragmentation;
+} freelist_allocator_stats;
+
+struct freelist_node;
+
+/*
+ * Состояние аллокатора.
+ */
+typedef struct freelist_allocator {
+    u64 total_size;
+    void* memory;
+    b8 owns_memory;
+    memory_tag tag;
+    freelist_fit_policy policy;
+
+    struct freelist_node* head;  // свободные участки, по возрастанию адреса
+    u64 free_space;
+    u64 allocation_count;
+} freelist_allocator;
+
+/*
+ * Создаёт аллокатор.
+ * 
+ * Параметры:
+ *   total_size    - размер области в байтах
+ *   memory        - готовая область (выровненная минимум по 16 байт) или 0,
+ *                   тогда область выделяется через kallocate с тегом tag
+ *   tag           - тег памяти для собственной области
+ *   policy        - стратегия поиска участка
+ *   out_allocator - куда записать состояние
+ * 
+ * Возвращает:
+ *   TRUE при успехе
+ */
+KAPI b8 freelist_allocator_create(u64 total_size, void* memory, memory_tag tag, freelist_fit_policy policy, freelist_allocator* out_allocator);
+
+/*
+ * Уничтожает аллокатор и освобождает область, если он ею владеет.
+ */
+KAPI void freelist_allocator_destroy(freelist_allocator* allocator);
+
+/*
+ * Выделяет size байт с выравниванием 16.
+ * 
+ * Возвращает:
+ *   Указатель на память или 0, если подходящего участка нет
+ */
+KAPI void* freelist_allocator_allocate(freelist_allocator* allocator, u64 size);
+
+/*
+ * Выделяет size байт с заданным выравниванием (степень двойки).
+ * Выравнивание, не равное степени двойки, - ошибка: возвращается 0.
+ */
+KAPI void* freelist_allocator_allocate_aligned(freelist_allocator* allocator, u64 size, u64 alignment);
+
+/*
+ * Возвращает блок в аллокатор, склеивая его с соседними свободными участками.
+ * Повторное освобождение и чужой указатель отвергаются с ошибкой в лог.
+ */
+KAPI void freelist_allocator_free(freelist_allocator* allocator, void* block);
+
+/*
+ * Возвращает суммарный объём свободной памяти в байтах.
+ */
+KAPI u64 freelist_allocator_free_space(const freelist_allocator* allocator);
+
+/*
+ * Возвращает размер самого большого непрерывного свободного участка.
+ * Это верхняя граница для одного выделения.
+ */
+KAPI u64 freelist_allocator_largest_free_block(const freelist_allocator* allocator);
+
+/*
+ * Заполняет статистику аллокатора (проходит по списку свободных участков).
+ */
+KAPI void freelist_allocator_get_stats(const freelist_allocator* allocator, freelist_allocator_stats* out_stats);
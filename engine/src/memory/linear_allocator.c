@@ -0,0 +1,89 @@
+#include "memory/linear_allocator.h"
+
+#include "core/kmemory.h"
+#include "core/logger.h"
+
+// Выравнивание по умолчанию - то же, что гарантирует malloc на 64-битных системах
+#define LINEAR_ALLOCATOR_DEFAULT_ALIGNMENT 16
+
+/*
+ * Создаёт линейный аллокатор поверх переданного блока
+ * или выделяет собственный блок.
+ */
+void linear_allocator_create(u64 total_size, void* memory, linear_allocator* out_allocator) {
+    if (!out_allocator) {
+        return;
+    }
+    out_allocator->total_size = total_size;
+    out_allocator->allocated = 0;
+    out_allocator->high_water_mark = 0;
+    out_allocator->owns_memory = memory == 0;
+    if (memory) {
+        out_allocator->memory = memory;
+    } else {
+        out_allocator->memory = kallocate_ex(total_size, 0, MEMORY_TAG_LINEAR_ALLOCATOR, KALLOCATE_FLAG_NO_ZERO);
+    }
+}
+
+/*
+ * Уничтожает аллокатор и, если нужно, освобождает блок.
+ */
+void linear_allocator_destroy(linear_allocator* allocator) {
+    if (!allocator) {
+        return;
+    }
+    if (allocator->owns_memory && allocator->memory) {
+        kfree(allocator->memory, allocator->total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+    allocator->memory = 0;
+    allocator->total_size = 0;
+    allocator->allocated = 0;
+    allocator->high_water_mark = 0;
+    allocator->owns_memory = FALSE;
+}
+
+/*
+ * Выделяет память с выравниванием по умолчанию.
+ */
+void* linear_allocator_allocate(linear_allocator* allocator, u64 size) {
+    return linear_allocator_allocate_aligned(allocator, size, LINEAR_ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+/*
+ * Выделяет память с заданным выравниванием.
+ * Текущая позиция округляется вверх до кратной alignment,
+ * затем сдвигается на size байт.
+ */
+void* linear_allocator_allocate_aligned(linear_allocator* allocator, u64 size, u64 alignment) {
+    if (!allocator || !allocator->memory) {
+        KERROR("linear_allocator_allocate - provided allocator not initialized.");
+        return 0;
+    }
+
+    // Выравниваем абсолютный адрес, а не смещение: блок может быть выровнен слабее
+    u64 base = (u64)allocator->memory;
+    u64 current = base + allocator->allocated;
+    u64 aligned = (current + (alignment - 1)) & ~(alignment - 1);
+    u64 new_allocated = (aligned - base) + size;
+
+    if (new_allocated > allocator->total_size) {
+        u64 remaining = allocator->total_size - allocator->allocated;
+        KERROR("linear_allocator_allocate - Tried to allocate %lluB, only %lluB remaining.", size, remaining);
+        return 0;
+    }
+
+    allocator->allocated = new_allocated;
+    if (new_allocated > allocator->high_water_mark) {
+        allocator->high_water_mark = new_allocated;
+    }
+    return (void*)aligned;
+}
+
+/*
+ * Сбрасывает аллокатор в начало блока.
+ */
+void linear_allocator_free_all(linear_allocator* allocator) {
+    if (allocator && allocator->memory) {
+        allocator->allocated = 0;
+    }
+}
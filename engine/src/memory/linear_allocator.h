@@ -0,0 +1,63 @@
+/*
+  Линейный (bump) аллокатор.
+
+  Память выдаётся последовательно из одного заранее выделенного блока:
+  выделение - это сдвиг указателя, отдельных освобождений нет.
+  Вся память возвращается разом через linear_allocator_free_all().
+  Подходит для данных, живущих ровно один кадр или один этап работы.
+*/
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Состояние линейного аллокатора.
+ */
+typedef struct linear_allocator {
+    u64 total_size;       // размер блока в байтах
+    u64 allocated;        // сколько байт уже выдано (включая выравнивание)
+    u64 high_water_mark;  // максимальное значение allocated за всё время
+    void* memory;         // начало блока
+    b8 owns_memory;       // TRUE - блок выделен самим аллокатором
+} linear_allocator;
+
+/*
+ * Создаёт линейный аллокатор.
+ * 
+ * Параметры:
+ *   total_size    - размер блока в байтах
+ *   memory        - готовый блок памяти или 0, тогда блок выделяется
+ *                   через kallocate с тегом MEMORY_TAG_LINEAR_ALLOCATOR
+ *   out_allocator - куда записать состояние аллокатора
+ */
+KAPI void linear_allocator_create(u64 total_size, void* memory, linear_allocator* out_allocator);
+
+/*
+ * Уничтожает аллокатор. Освобождает блок, если аллокатор им владеет.
+ */
+KAPI void linear_allocator_destroy(linear_allocator* allocator);
+
+/*
+ * Выделяет size байт с выравниванием по 16 байт.
+ * 
+ * Возвращает:
+ *   Указатель на память или 0, если места не хватило
+ */
+KAPI void* linear_allocator_allocate(linear_allocator* allocator, u64 size);
+
+/*
+ * Выделяет size байт с заданным выравниванием.
+ * 
+ * Параметры:
+ *   alignment - выравнивание в байтах, степень двойки
+ * 
+ * Возвращает:
+ *   Указатель на память или 0, если места не хватило
+ */
+KAPI void* linear_allocator_allocate_aligned(linear_allocator* allocator, u64 size, u64 alignment);
+
+/*
+ * Освобождает всю выданную память разом (сбрасывает указатель в начало).
+ * Содержимое блока не обнуляется.
+ */
+KAPI void linear_allocator_free_all(linear_allocator* allocator);
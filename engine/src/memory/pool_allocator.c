@@ -0,0 +1,115 @@
+#include "memory/pool_allocator.h"
+
+#include "core/logger.h"
+
+// Заголовок slab: указатель на следующий slab, дополненный до 16 байт,
+// чтобы блоки начинались с того же выравнивания, что и сам slab
+#define POOL_SLAB_HEADER_SIZE 16
+
+/*
+ * Размер slab в байтах вместе с заголовком.
+ */
+static u64 pool_slab_size(const pool_allocator* allocator) {
+    return POOL_SLAB_HEADER_SIZE + allocator->block_size * allocator->blocks_per_slab;
+}
+
+/*
+ * Создаёт пул (без выделения памяти).
+ */
+void pool_allocator_create(u64 block_size, u64 blocks_per_slab, memory_tag tag, pool_allocator* out_allocator) {
+    if (!out_allocator) {
+        return;
+    }
+    // В свободном блоке хранится указатель, поэтому блок не меньше указателя;
+    // размер кратен 8, чтобы все блоки оставались выровненными
+    if (block_size < sizeof(void*)) {
+        block_size = sizeof(void*);
+    }
+    block_size = (block_size + 7) & ~(u64)7;
+    if (blocks_per_slab == 0) {
+        blocks_per_slab = 1;
+    }
+
+    kzero_memory(out_allocator, sizeof(pool_allocator));
+    out_allocator->block_size = block_size;
+    out_allocator->blocks_per_slab = blocks_per_slab;
+    out_allocator->tag = tag;
+}
+
+/*
+ * Освобождает все slab пула.
+ */
+void pool_allocator_destroy(pool_allocator* allocator) {
+    if (!allocator) {
+        return;
+    }
+    u64 slab_size = pool_slab_size(allocator);
+    void* slab = allocator->slabs;
+    while (slab) {
+        void* next = *(void**)slab;
+        kfree(slab, slab_size, allocator->tag);
+        slab = next;
+    }
+    kzero_memory(allocator, sizeof(pool_allocator));
+}
+
+/*
+ * Выделяет блок: сначала из списка свободных, затем из нетронутого
+ * хвоста последнего slab, и только потом заводит новый slab.
+ */
+void* pool_allocator_allocate(pool_allocator* allocator) {
+    void* block = allocator->free_list;
+    if (block) {
+        // Снимаем блок с головы интрузивного списка
+        allocator->free_list = *(void**)block;
+    } else {
+        if (allocator->slab_cursor == allocator->slab_end) {
+            // Места нет - новый slab. Блоки не нарезаются в список заранее:
+            // курсор просто идёт по slab, поэтому рост пула тоже O(1)
+            u8* slab = kallocate_ex(pool_slab_size(allocator), 0, allocator->tag, KALLOCATE_FLAG_NO_ZERO);
+            *(void**)slab = allocator->slabs;
+            allocator->slabs = slab;
+            allocator->slab_cursor = slab + POOL_SLAB_HEADER_SIZE;
+            allocator->slab_end = allocator->slab_cursor + allocator->block_size * allocator->blocks_per_slab;
+            allocator->slab_count++;
+        }
+        block = allocator->slab_cursor;
+        allocator->slab_cursor += allocator->block_size;
+    }
+
+    allocator->blocks_in_use++;
+    if (allocator->blocks_in_use > allocator->peak_in_use) {
+        allocator->peak_in_use = allocator->blocks_in_use;
+    }
+    return block;
+}
+
+/*
+ * Кладёт блок в голову списка свободных.
+ */
+void pool_allocator_free(pool_allocator* allocator, void* block) {
+    if (!block) {
+        return;
+    }
+    if (allocator->blocks_in_use == 0) {
+        KERROR("pool_allocator_free - pool has no blocks in use, possible double free.");
+        return;
+    }
+    *(void**)block = allocator->free_list;
+    allocator->free_list = block;
+    allocator->blocks_in_use--;
+}
+
+/*
+ * Заполняет статистику пула.
+ */
+void pool_allocator_get_stats(const pool_allocator* allocator, pool_allocator_stats* out_stats) {
+    if (!allocator || !out_stats) {
+        return;
+    }
+    out_stats->block_size = allocator->block_size;
+    out_stats->blocks_in_use = allocator->blocks_in_use;
+    out_stats->block_capacity = allocator->slab_count * allocator->blocks_per_slab;
+    out_stats->slab_count = allocator->slab_count;
+    out_stats->peak_in_use = allocator->peak_in_use;
+}
@@ -0,0 +1,82 @@
+/*
+  Пуловый аллокатор блоков фиксированного размера.
+
+  Память берётся у kallocate крупными кусками (slab) с заданным тегом,
+  внутри slab нарезается на одинаковые блоки. Свободные блоки связаны
+  в интрузивный список: указатель на следующий свободный блок хранится
+  прямо в самом блоке. Выделение и освобождение - O(1), без блокировок
+  и без фрагментации.
+
+  Аллокатор не потокобезопасен: пул должен принадлежать одному потоку.
+*/
+#pragma once
+
+#include "defines.h"
+#include "core/kmemory.h"
+
+/*
+ * Статистика пула.
+ */
+typedef struct pool_allocator_stats {
+    u64 block_size;      // размер блока в байтах (после выравнивания)
+    u64 blocks_in_use;   // сколько блоков сейчас выдано
+    u64 block_capacity;  // сколько блоков помещается во всех slab
+    u64 slab_count;      // количество slab
+    u64 peak_in_use;     // максимум blocks_in_use за всё время
+} pool_allocator_stats;
+
+/*
+ * Состояние пулового аллокатора.
+ */
+typedef struct pool_allocator {
+    u64 block_size;       // размер блока (кратен 8, не меньше указателя)
+    u64 blocks_per_slab;  // блоков в одном slab
+    memory_tag tag;       // тег, под которым выделяются slab
+
+    void* free_list;      // голова списка освобождённых блоков
+    void* slabs;          // список slab (первые байты slab - указатель на следующий)
+    u8* slab_cursor;      // первый ещё ни разу не выданный блок в последнем slab
+    u8* slab_end;         // конец последнего slab
+
+    u64 blocks_in_use;
+    u64 slab_count;
+    u64 peak_in_use;
+} pool_allocator;
+
+/*
+ * Создаёт пул. Память под slab выделяется лениво, при первом выделении.
+ * 
+ * Параметры:
+ *   block_size      - размер одного блока в байтах
+ *   blocks_per_slab - сколько блоков выделять за раз
+ *   tag             - тег памяти для slab (например, MEMORY_TAG_ENTITY)
+ *   out_allocator   - куда записать состояние пула
+ */
+KAPI void pool_allocator_create(u64 block_size, u64 blocks_per_slab, memory_tag tag, pool_allocator* out_allocator);
+
+/*
+ * Уничтожает пул и освобождает все slab.
+ * Все выданные блоки становятся недействительными.
+ */
+KAPI void pool_allocator_destroy(pool_allocator* allocator);
+
+/*
+ * Выделяет один блок. Содержимое блока не обнуляется.
+ * 
+ * Возвращает:
+ *   Указатель на блок
+ */
+KAPI void* pool_allocator_allocate(pool_allocator* allocator);
+
+/*
+ * Возвращает блок в пул.
+ * 
+ * Параметры:
+ *   block - блок, ранее выданный этим же пулом
+ */
+KAPI void pool_allocator_free(pool_allocator* allocator, void* block);
+
+/*
+ * Заполняет статистику пула.
+ */
+KAPI void pool_allocator_get_stats(const pool_allocator* allocator, pool_allocator_stats* out_stats);
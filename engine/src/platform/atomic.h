@@ -0,0 +1,159 @@
+/*
+
+   Атомарные операции.
+
+   Типы atomic_u32, atomic_u64 и atomic_ptr - обёртки над значением, к
+   которому нельзя обратиться обычным чтением или записью: только через
+   функции ниже, каждая с явным порядком памяти. Так в коде видно, какие
+   поля общие между потоками и какую синхронизацию даёт каждый доступ.
+
+   Реализация - встроенные функции __atomic компилятора (clang и gcc на
+   всех платформах движка), поэтому всё здесь inline и не зависит от ОС.
+
+ */
+
+#pragma once
+
+#include "defines.h"
+
+/*
+ * Порядок памяти.
+ *   RELAXED - только атомарность, без упорядочивания с другими доступами
+ *   ACQUIRE - последующие доступы не переезжают выше (чтение флага/указателя)
+ *   RELEASE - предыдущие доступы не переезжают ниже (публикация данных)
+ *   ACQ_REL - ACQUIRE + RELEASE (чтение-изменение-запись)
+ *   SEQ_CST - единый порядок для всех SEQ_CST-операций всех потоков
+ */
+typedef enum atomic_order {
+    ATOMIC_ORDER_RELAXED = __ATOMIC_RELAXED,
+    ATOMIC_ORDER_ACQUIRE = __ATOMIC_ACQUIRE,
+    ATOMIC_ORDER_RELEASE = __ATOMIC_RELEASE,
+    ATOMIC_ORDER_ACQ_REL = __ATOMIC_ACQ_REL,
+    ATOMIC_ORDER_SEQ_CST = __ATOMIC_SEQ_CST
+} atomic_order;
+
+// Атомарные значения. Обнулённая структура - значение 0
+typedef struct atomic_u32 {
+    volatile u32 value;
+} atomic_u32;
+
+typedef struct atomic_u64 {
+    volatile u64 value;
+} atomic_u64;
+
+typedef struct atomic_ptr {
+    void* volatile value;
+} atomic_ptr;
+
+/* - - - u32 - - - */
+
+static inline u32 atomic_load_u32(const atomic_u32* atomic, atomic_order order) {
+    return __atomic_load_n(&atomic->value, order);
+}
+
+static inline void atomic_store_u32(atomic_u32* atomic, u32 value, atomic_order order) {
+    __atomic_store_n(&atomic->value, value, order);
+}
+
+// Записывает value, возвращает прежнее значение
+static inline u32 atomic_exchange_u32(atomic_u32* atomic, u32 value, atomic_order order) {
+    return __atomic_exchange_n(&atomic->value, value, order);
+}
+
+/*
+ * Если значение равно *expected, записывает desired и возвращает TRUE
+ * (порядок success). Иначе записывает текущее значение в *expected и
+ * возвращает FALSE (порядок failure: не RELEASE/ACQ_REL и не сильнее success).
+ */
+static inline b8 atomic_compare_exchange_u32(atomic_u32* atomic, u32* expected, u32 desired,
+                                             atomic_order success, atomic_order failure) {
+    return __atomic_compare_exchange_n(&atomic->value, expected, desired, FALSE, success, failure);
+}
+
+// Операции чтения-изменения-записи возвращают значение до изменения
+static inline u32 atomic_fetch_add_u32(atomic_u32* atomic, u32 value, atomic_order order) {
+    return __atomic_fetch_add(&atomic->value, value, order);
+}
+
+static inline u32 atomic_fetch_sub_u32(atomic_u32* atomic, u32 value, atomic_order order) {
+    return __atomic_fetch_sub(&atomic->value, value, order);
+}
+
+static inline u32 atomic_fetch_and_u32(atomic_u32* atomic, u32 value, atomic_order order) {
+    return __atomic_fetch_and(&atomic->value, value, order);
+}
+
+static inline u32 atomic_fetch_or_u32(atomic_u32* atomic, u32 value, atomic_order order) {
+    return __atomic_fetch_or(&atomic->value, value, order);
+}
+
+/* - - - u64 - - - */
+
+static inline u64 atomic_load_u64(const atomic_u64* atomic, atomic_order order) {
+    return __atomic_load_n(&atomic->value, order);
+}
+
+static inline void atomic_store_u64(atomic_u64* atomic, u64 value, atomic_order order) {
+    __atomic_store_n(&atomic->value, value, order);
+}
+
+static inline u64 atomic_exchange_u64(atomic_u64* atomic, u64 value, atomic_order order) {
+    return __atomic_exchange_n(&atomic->value, value, order);
+}
+
+static inline b8 atomic_compare_exchange_u64(atomic_u64* atomic, u64* expected, u64 desired,
+                                             atomic_order success, atomic_order failure) {
+    return __atomic_compare_exchange_n(&atomic->value, expected, desired, FALSE, success, failure);
+}
+
+static inline u64 atomic_fetch_add_u64(atomic_u64* atomic, u64 value, atomic_order order) {
+    return __atomic_fetch_add(&atomic->value, value, order);
+}
+
+static inline u64 atomic_fetch_sub_u64(atomic_u64* atomic, u64 value, atomic_order order) {
+    return __atomic_fetch_sub(&atomic->value, value, order);
+}
+
+static inline u64 atomic_fetch_and_u64(atomic_u64* atomic, u64 value, atomic_order order) {
+    return __atomic_fetch_and(&atomic->value, value, order);
+}
+
+static inline u64 atomic_fetch_or_u64(atomic_u64* atomic, u64 value, atomic_order order) {
+    return __atomic_fetch_or(&atomic->value, value, order);
+}
+
+/* - - - указатели - - - */
+
+static inline void* atomic_load_ptr(const atomic_ptr* atomic, atomic_order order) {
+    return __atomic_load_n(&atomic->value, order);
+}
+
+static inline void atomic_store_ptr(atomic_ptr* atomic, void* value, atomic_order order) {
+    __atomic_store_n(&atomic->value, value, order);
+}
+
+static inline void* atomic_exchange_ptr(atomic_ptr* atomic, void* value, atomic_order order) {
+    return __atomic_exchange_n(&atomic->value, value, order);
+}
+
+static inline b8 atomic_compare_exchange_ptr(atomic_ptr* atomic, void** expected, void* desired,
+                                             atomic_order success, atomic_order failure) {
+    return __atomic_compare_exchange_n(&atomic->value, expected, desired, FALSE, success, failure);
+}
+
+/* - - - барьеры - - - */
+
+// Барьер памяти для неатомарных и relaxed-доступов потока
+static inline void atomic_fence(atomic_order order) {
+    __atomic_thread_fence(order);
+}
+
+// Подсказка процессору внутри цикла ожидания (pause/yield): экономит
+// энергию и не мешает второму логическому ядру
+static inline void atomic_spin_pause() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ volatile("yield");
+#endif
+}
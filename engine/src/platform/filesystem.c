@@ -0,0 +1,105 @@
+#include "platform/filesystem.h"
+
+#include "core/logger.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+b8 filesystem_exists(const char* path) {
+#ifdef _MSC_VER
+    struct _stat buffer;
+    return _stat(path, &buffer) == 0;
+#else
+    struct stat buffer;
+    return stat(path, &buffer) == 0;
+#endif
+}
+
+b8 filesystem_rename(const char* from, const char* to) {
+    return rename(from, to) == 0;
+}
+
+b8 filesystem_delete(const char* path) {
+    return remove(path) == 0;
+}
+
+b8 filesystem_open(const char* path, file_modes mode, b8 binary, file_handle* out_handle) {
+    out_handle->is_valid = FALSE;
+    out_handle->handle = 0;
+    const char* mode_str;
+
+    if ((mode & FILE_MODE_READ) != 0 && (mode & FILE_MODE_WRITE) != 0) {
+        mode_str = binary ? "w+b" : "w+";
+    } else if ((mode & FILE_MODE_READ) != 0 && (mode & FILE_MODE_WRITE) == 0) {
+        mode_str = binary ? "rb" : "r";
+    } else if ((mode & FILE_MODE_READ) == 0 && (mode & FILE_MODE_WRITE) != 0) {
+        mode_str = binary ? "wb" : "w";
+    } else {
+        KERROR("Invalid mode passed while trying to open file: '%s'", path);
+        return FALSE;
+    }
+
+    // Пытаемся открыть файл
+    FILE* file = fopen(path, mode_str);
+    if (!file) {
+        KERROR("Error opening file: '%s'", path);
+        return FALSE;
+    }
+
+    out_handle->handle = file;
+    out_handle->is_valid = TRUE;
+    return TRUE;
+}
+
+void filesystem_close(file_handle* handle) {
+    if (handle->handle) {
+        fclose((FILE*)handle->handle);
+        handle->handle = 0;
+        handle->is_valid = FALSE;
+    }
+}
+
+b8 filesystem_size(file_handle* handle, u64* out_size) {
+    if (!handle->handle || !out_size) {
+        return FALSE;
+    }
+    FILE* file = (FILE*)handle->handle;
+    long position = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, position, SEEK_SET);
+    if (size < 0) {
+        return FALSE;
+    }
+    *out_size = (u64)size;
+    return TRUE;
+}
+
+b8 filesystem_read(file_handle* handle, u64 data_size, void* out_data, u64* out_bytes_read) {
+    if (handle->handle && out_data) {
+        *out_bytes_read = fread(out_data, 1, data_size, (FILE*)handle->handle);
+        if (*out_bytes_read != data_size) {
+            return FALSE;
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+b8 filesystem_write(file_handle* handle, u64 data_size, const void* data, u64* out_bytes_written) {
+    if (handle->handle) {
+        *out_bytes_written = fwrite(data, 1, data_size, (FILE*)handle->handle);
+        if (*out_bytes_written != data_size) {
+            return FALSE;
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+b8 filesystem_flush(file_handle* handle) {
+    if (handle->handle) {
+        return fflush((FILE*)handle->handle) == 0;
+    }
+    return FALSE;
+}
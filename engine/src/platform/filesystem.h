@@ -0,0 +1,79 @@
+/*
+
+   Файловая система - тонкая обёртка над файлами ОС.
+
+*/
+
+#pragma once
+
+#include "defines.h"
+
+// Дескриптор файла
+typedef struct file_handle {
+    // Внутренний дескриптор (FILE*)
+    void* handle;
+    b8 is_valid;
+} file_handle;
+
+// Режимы открытия (можно комбинировать)
+typedef enum file_modes {
+    FILE_MODE_READ = 0x1,
+    FILE_MODE_WRITE = 0x2
+} file_modes;
+
+/*
+ * Проверяет, существует ли файл.
+ */
+KAPI b8 filesystem_exists(const char* path);
+
+/*
+ * Переименовывает файл. Файл с именем to не должен существовать.
+ */
+KAPI b8 filesystem_rename(const char* from, const char* to);
+
+/*
+ * Удаляет файл.
+ */
+KAPI b8 filesystem_delete(const char* path);
+
+/*
+ * Открывает файл.
+ *
+ * Параметры:
+ *   path - путь к файлу
+ *   mode - комбинация file_modes; FILE_MODE_WRITE без FILE_MODE_READ
+ *          создаёт файл заново
+ *   binary - открыть в двоичном режиме
+ *   out_handle - заполняемый дескриптор
+ *
+ * Возвращает:
+ *   TRUE - файл открыт; FALSE - ошибка
+ */
+KAPI b8 filesystem_open(const char* path, file_modes mode, b8 binary, file_handle* out_handle);
+
+/*
+ * Закрывает файл.
+ */
+KAPI void filesystem_close(file_handle* handle);
+
+/*
+ * Возвращает размер файла в байтах через out_size.
+ */
+KAPI b8 filesystem_size(file_handle* handle, u64* out_size);
+
+/*
+ * Читает до data_size байт в out_data.
+ * Количество прочитанных байт - в out_bytes_read.
+ */
+KAPI b8 filesystem_read(file_handle* handle, u64 data_size, void* out_data, u64* out_bytes_read);
+
+/*
+ * Записывает data_size байт из data.
+ * Количество записанных байт - в out_bytes_written.
+ */
+KAPI b8 filesystem_write(file_handle* handle, u64 data_size, const void* data, u64* out_bytes_written);
+
+/*
+ * Сбрасывает буферы файла на диск (в ОС).
+ */
+KAPI b8 filesystem_flush(file_handle* handle);
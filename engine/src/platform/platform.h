@@ -2,13 +2,14 @@
 
    Этот код представляет собой интерфейс для взаимодействия с платформой,
    Все функции описаны как платформо-зависимые,
-   то есть их реализация будет зависеть от конкретной платформы (Windows).
+   то есть их реализация будет зависеть от конкретной платформы (Windows, Linux).
 
  */
 
 #pragma once
 
 #include <defines.h>
+#include <platform/atomic.h>
 
 // состояние платформы
 typedef struct platform_state {
@@ -43,16 +44,45 @@ void platform_shutdown(platform_state *plat_state);
 b8 platform_pump_messages(platform_state *plat_state);
 
 /* - - - Функции управления памятью - - */
+// Размер кэш-линии, под который выравниваются и разносятся данные разных
+// потоков. Настоящий размер - platform_get_cache_line_size()
+#define PLATFORM_CACHE_LINE_SIZE 64
+
+// Выравнивание блоков platform_allocate(size, TRUE) - размер кэш-линии
+#define PLATFORM_DEFAULT_ALIGNMENT PLATFORM_CACHE_LINE_SIZE
+
 // Аллоцирует блок памяти заданного размера (size). Если aligned == true, память
-// будет выровнена по определенному адресу (например, 16 байт или 32 байта)
+// будет выровнена по PLATFORM_DEFAULT_ALIGNMENT (кэш-линия), иначе - обычный malloc
 void *platform_allocate(u64 size, b8 aligned);
 
-// Освобождает ранее выделенную память через указатель block
+// Аллоцирует блок, выровненный по alignment байт (степень двойки, не меньше
+// размера указателя, например 16/32/64 или размер страницы 4096).
+// Освобождать только через platform_free_aligned (или platform_free(block, TRUE)).
+void *platform_allocate_aligned(u64 size, u64 alignment);
+
+// То же, что platform_allocate, но память уже обнулена. Обнуление делает
+// системный аллокатор (calloc), который для больших блоков берёт у ОС
+// заведомо чистые страницы и не трогает их лишний раз.
+void *platform_allocate_zeroed(u64 size, b8 aligned);
+
+// Изменяет размер блока, выделенного platform_allocate(size, FALSE).
+// Если за блоком есть место (или ОС может переотобразить страницы, как
+// mremap в glibc для больших блоков), данные не копируются. Иначе содержимое
+// переносится в новый блок. Новые байты не обнуляются.
+void *platform_reallocate(void *block, u64 new_size);
+
+// Освобождает ранее выделенную память через указатель block.
+// aligned должен совпадать с тем, что передавался в platform_allocate
 void platform_free(void *block, b8 aligned);
+
+// Освобождает блок, выделенный через platform_allocate_aligned
+void platform_free_aligned(void *block);
 // обнуляет размер size заданного block памяти, но не освобождает!!!
 void *platform_zero_memory(void *block, u64 size);
 // Копирует данные из одной области source памяти в другую dest размером size
 void *platform_copy_memory(void *dest, const void *source, u64 size);
+// То же, что platform_copy_memory, но области source и dest могут пересекаться
+void *platform_move_memory(void *dest, const void *source, u64 size);
 // Заполняет блок памяти dest заданным значением value(например, заполняет
 // массив чисел заданным значением)
 void *platform_set_memory(void *dest, i32 value, u64 size);
@@ -63,8 +93,9 @@ void platform_console_write(const char *message, u8 colour);
 // Печатает сообщение об ошибке в консоль, также с указанием цвета
 void platform_console_write_error(const char *message, u8 colour);
 
-// Возвращает абсолютное время в формате с плавающей точкой
-f64 platform_get_absolute_time();
+// Возвращает абсолютное время в формате с плавающей точкой.
+// Экспортируется: по нему меряют время утилиты из tools/
+KAPI f64 platform_get_absolute_time();
 
 // Задерживает выполнение текущего потока на указанное количество миллисекунд.
 // Это блокирует выполнение основного потока. Функция используется для того,
@@ -72,3 +103,114 @@ f64 platform_get_absolute_time();
 // задачи. Эта функция не экспортируется, то есть не предназначена для
 // использования в других частях программы напрямую.
 void platform_sleep(u64 ms);
+
+/* - - - Потоки и синхронизация - - - */
+
+// Функция потока. Возвращаемое значение - код завершения потока
+typedef u32 (*pfn_thread_start)(void *params);
+
+// Поток ОС
+typedef struct platform_thread {
+  // Платформенный дескриптор потока
+  void *internal_data;
+} platform_thread;
+
+// Семафор - счётчик, на котором поток может спать до сигнала
+typedef struct platform_semaphore {
+  // Платформенный объект семафора
+  void *internal_data;
+} platform_semaphore;
+
+// Хранилище примитива синхронизации прямо в структуре: слово futex (Linux)
+// или объект размером в указатель (Windows: SRWLOCK, CONDITION_VARIABLE)
+typedef union platform_sync_storage {
+  atomic_u32 word;
+  void *pointer;
+} platform_sync_storage;
+
+// Мьютекс. Состояние хранится в самой структуре, поэтому обнулённая
+// структура - свободный мьютекс, готовый к работе без
+// platform_mutex_create. Не рекурсивный
+typedef struct platform_mutex {
+  platform_sync_storage storage;
+} platform_mutex;
+
+// Условная переменная. Как и мьютекс, обнулённая структура готова к работе
+typedef struct platform_condition {
+  platform_sync_storage storage;
+} platform_condition;
+
+// Таймаут ожидания "без ограничения"
+#define PLATFORM_WAIT_INFINITE 0xFFFFFFFFFFFFFFFFull
+
+// Запускает поток, выполняющий start(params). TRUE - поток создан
+KAPI b8 platform_thread_create(pfn_thread_start start, void *params,
+                               platform_thread *out_thread);
+
+// Ждёт завершения потока и освобождает его дескриптор
+KAPI void platform_thread_join(platform_thread *thread);
+
+// Уступает остаток кванта другим готовым потокам (без сна)
+void platform_thread_yield();
+
+// Разрешает потоку (0 - вызывающему) выполняться только на процессорах,
+// отмеченных битами processor_mask (бит i - процессор i).
+// FALSE - маска пуста или ОС отказала
+b8 platform_thread_set_affinity(platform_thread *thread, u64 processor_mask);
+
+// Количество логических процессоров, доступных процессу (не меньше 1)
+u32 platform_get_processor_count();
+
+// Размер кэш-линии данных L1 в байтах (PLATFORM_CACHE_LINE_SIZE, если
+// ОС его не сообщает)
+u32 platform_get_cache_line_size();
+
+// Создаёт семафор с начальным значением initial_count
+b8 platform_semaphore_create(u32 initial_count, platform_semaphore *out_semaphore);
+
+// Уничтожает семафор
+void platform_semaphore_destroy(platform_semaphore *semaphore);
+
+// Увеличивает счётчик семафора, будя один ожидающий поток
+void platform_semaphore_signal(platform_semaphore *semaphore);
+
+// Ждёт сигнала не дольше timeout_ms миллисекунд (PLATFORM_WAIT_INFINITE -
+// без ограничения). Возвращает TRUE, если сигнал получен, FALSE - по
+// истечении времени
+b8 platform_semaphore_wait(platform_semaphore *semaphore, u64 timeout_ms);
+
+// Готовит мьютекс к работе (то же, что обнулить структуру)
+void platform_mutex_create(platform_mutex *out_mutex);
+
+// Уничтожает мьютекс. Мьютекс не должен быть захвачен
+void platform_mutex_destroy(platform_mutex *mutex);
+
+// Захватывает мьютекс. Сначала недолго крутится, затем спит в ядре
+void platform_mutex_lock(platform_mutex *mutex);
+
+// Захватывает мьютекс, если он свободен. TRUE - захвачен
+b8 platform_mutex_try_lock(platform_mutex *mutex);
+
+// Освобождает мьютекс, будя один ожидающий поток
+void platform_mutex_unlock(platform_mutex *mutex);
+
+// Готовит условную переменную к работе (то же, что обнулить структуру)
+void platform_condition_create(platform_condition *out_condition);
+
+// Уничтожает условную переменную. Ожидающих потоков быть не должно
+void platform_condition_destroy(platform_condition *condition);
+
+// Освобождает захваченный mutex и ждёт сигнала не дольше timeout_ms
+// (PLATFORM_WAIT_INFINITE - без ограничения), затем снова захватывает mutex.
+// Пробуждение возможно и без сигнала: условие проверяется в цикле.
+// Возвращает FALSE по истечении времени
+b8 platform_condition_wait(platform_condition *condition, platform_mutex *mutex, u64 timeout_ms);
+
+// Будит один поток, ждущий условную переменную
+void platform_condition_signal(platform_condition *condition);
+
+// Будит все потоки, ждущие условную переменную
+void platform_condition_broadcast(platform_condition *condition);
+
+// Выталкивает буферизованный консольный вывод (если платформа его копит)
+void platform_console_flush();
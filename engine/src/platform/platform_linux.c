@@ -0,0 +1,563 @@
+/*
+
+   Реализация платформенного слоя для Linux.
+   Работает в безоконном (headless) режиме: окно не создаётся,
+   движок крутит цикл на сборочных и симуляционных серверах без дисплея.
+
+ */
+
+// pthread_setaffinity_np и CPU_SET - расширения GNU
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "platform/platform.h"
+
+// Linux platform layer.
+#if KPLATFORM_LINUX
+
+#include "core/logger.h"
+#include "platform/atomic.h"
+
+#include <signal.h>
+#include <stdio.h>   // snprintf
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>    // clock_gettime, nanosleep
+#include <unistd.h>  // write
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>   // sched_yield, cpu_set_t
+#include <limits.h>  // INT_MAX
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+typedef struct internal_state {
+    const char *application_name;  // имя приложения (для сообщений в лог)
+    i32 width;   // "виртуальный" размер окна, которого нет
+    i32 height;
+} internal_state;
+
+// Размер буфера консольного вывода. Сообщения копятся здесь и уходят
+// одним вызовом write(2), а не по одному на каждую строку лога.
+#define CONSOLE_BUFFER_SIZE 16384
+
+typedef struct console_buffer {
+    char data[CONSOLE_BUFFER_SIZE];
+    u64 used;  // сколько байт уже занято
+} console_buffer;
+
+static console_buffer console_out;         // буфер для stdout
+// Консоль пишут и главный поток, и поток записи логгера
+static pthread_mutex_t console_mutex = PTHREAD_MUTEX_INITIALIZER;
+static b8 console_atexit_registered = FALSE;
+
+// Флаг запроса на завершение (SIGINT/SIGTERM).
+// sig_atomic_t - единственный тип, который безопасно писать из обработчика сигнала.
+static volatile sig_atomic_t quit_requested = 0;
+
+//обработчик сигналов завершения
+static void linux_signal_handler(int signal_number) {
+    quit_requested = 1;
+}
+
+//записывает весь блок в дескриптор, повторяя write при частичной записи и EINTR
+static void linux_write_all(int fd, const char *data, u64 size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Писать больше некуда - молча выходим, логировать ошибку логгера нельзя
+            return;
+        }
+        data += written;
+        size -= (u64)written;
+    }
+}
+
+//сбрасывает накопленный буфер stdout одним системным вызовом (под блокировкой)
+static void linux_console_flush_locked() {
+    if (console_out.used > 0) {
+        linux_write_all(STDOUT_FILENO, console_out.data, console_out.used);
+        console_out.used = 0;
+    }
+}
+
+//сбрасывает буфер stdout
+static void linux_console_flush() {
+    pthread_mutex_lock(&console_mutex);
+    linux_console_flush_locked();
+    pthread_mutex_unlock(&console_mutex);
+}
+
+//добавляет кусок строки в буфер stdout, сбрасывая его при переполнении
+static void linux_console_append(const char *data, u64 size) {
+    if (console_out.used + size > CONSOLE_BUFFER_SIZE) {
+        linux_console_flush_locked();
+    }
+    // Сообщение больше всего буфера - пишем напрямую
+    if (size > CONSOLE_BUFFER_SIZE) {
+        linux_write_all(STDOUT_FILENO, data, size);
+        return;
+    }
+    memcpy(console_out.data + console_out.used, data, size);
+    console_out.used += size;
+}
+
+//Эта функция инициализирует платформу
+//окно не создаётся, только состояние и обработчики сигналов
+b8 platform_startup(
+    platform_state *plat_state,
+    const char *application_name,
+    i32 x,
+    i32 y,
+    i32 width,
+    i32 height)
+{
+    //Выделение памяти для состояния приложения
+    plat_state->internal_state = malloc(sizeof(internal_state));
+    internal_state *state = (internal_state *)plat_state->internal_state;
+    state->application_name = application_name;
+    state->width = width;
+    state->height = height;
+
+    // Ctrl+C и остановка сервиса должны корректно завершать цикл движка
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = linux_signal_handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+
+    KINFO("Linux platform started in headless mode (%s).", application_name);
+    u32 cache_line_size = platform_get_cache_line_size();
+    KINFO("%u logical processor(s), %u-byte cache line.", platform_get_processor_count(), cache_line_size);
+    if (cache_line_size > PLATFORM_CACHE_LINE_SIZE) {
+        KWARN("Cache line is larger than PLATFORM_CACHE_LINE_SIZE (%u): per-thread data may share lines.",
+              PLATFORM_CACHE_LINE_SIZE);
+    }
+    return TRUE;
+}
+
+//Функция завершения платформенного слоя
+void platform_shutdown(platform_state *plat_state) {
+    linux_console_flush();
+    if (plat_state->internal_state) {
+        free(plat_state->internal_state);
+        plat_state->internal_state = 0;
+    }
+}
+
+//обработка "сообщений ОС"
+//окна нет, поэтому проверяем только запрос на завершение.
+//Раз в кадр сбрасываем консольный буфер - один write(2) на кадр.
+b8 platform_pump_messages(platform_state *plat_state) {
+    linux_console_flush();
+    return quit_requested ? FALSE : TRUE;
+}
+
+/* - абстракция(обёртки) - */
+
+//выделение памяти
+void *platform_allocate(u64 size, b8 aligned) {
+    if (aligned) {
+        return platform_allocate_aligned(size, PLATFORM_DEFAULT_ALIGNMENT);
+    }
+    return malloc(size);
+}
+
+//выделение выровненной памяти
+void *platform_allocate_aligned(u64 size, u64 alignment) {
+    void *block = 0;
+    if (posix_memalign(&block, alignment, size) != 0) {
+        return 0;
+    }
+    return block;
+}
+
+//выделение обнулённой памяти
+void *platform_allocate_zeroed(u64 size, b8 aligned) {
+    if (aligned) {
+        // Выровненного calloc нет - обнуляем сами
+        void *block = platform_allocate_aligned(size, PLATFORM_DEFAULT_ALIGNMENT);
+        return block ? memset(block, 0, size) : 0;
+    }
+    return calloc(1, size);
+}
+
+//изменение размера блока (без выравнивания)
+void *platform_reallocate(void *block, u64 new_size) {
+    return realloc(block, new_size);
+}
+
+//освобождение памяти
+void platform_free(void *block, b8 aligned) {
+    // В glibc posix_memalign и malloc освобождаются одинаково
+    free(block);
+}
+
+//освобождение выровненной памяти
+void platform_free_aligned(void *block) {
+    free(block);
+}
+
+//обнуление памяти
+void *platform_zero_memory(void *block, u64 size) {
+    return memset(block, 0, size);
+}
+
+//копирование данных
+void *platform_copy_memory(void *dest, const void *source, u64 size) {
+    return memcpy(dest, source, size);
+}
+
+//копирование пересекающихся областей
+void *platform_move_memory(void *dest, const void *source, u64 size) {
+    return memmove(dest, source, size);
+}
+
+//заполнение значением памяти
+void *platform_set_memory(void *dest, i32 value, u64 size) {
+    return memset(dest, value, size);
+}
+
+//функция логирования в консоль (буферизованная)
+void platform_console_write(const char *message, u8 colour) {
+    // Буфер сбрасывается и при выходе из процесса, даже если
+    // platform_shutdown так и не был вызван
+    if (!console_atexit_registered) {
+        atexit(linux_console_flush);
+        console_atexit_registered = TRUE;
+    }
+    // FATAL,ERROR,WARN,INFO,DEBUG,TRACE
+    static const char *colour_strings[6] = {"0;41", "1;31", "1;33", "1;32", "1;34", "1;30"};
+    char prefix[16];
+    i32 prefix_length = snprintf(prefix, sizeof(prefix), "\033[%sm", colour_strings[colour]);
+
+    pthread_mutex_lock(&console_mutex);
+    linux_console_append(prefix, (u64)prefix_length);
+    linux_console_append(message, strlen(message));
+    linux_console_append("\033[0m", 4);
+    pthread_mutex_unlock(&console_mutex);
+}
+
+//функция для вывода ошибок в stderr (без буферизации)
+void platform_console_write_error(const char *message, u8 colour) {
+    // Сначала выталкиваем stdout, чтобы сохранить порядок сообщений.
+    // Блокировку держим до конца, чтобы между ними не вклинился другой поток
+    pthread_mutex_lock(&console_mutex);
+    linux_console_flush_locked();
+
+    // FATAL,ERROR,WARN,INFO,DEBUG,TRACE
+    static const char *colour_strings[6] = {"0;41", "1;31", "1;33", "1;32", "1;34", "1;30"};
+    char out[CONSOLE_BUFFER_SIZE];
+    i32 length = snprintf(out, sizeof(out), "\033[%sm%s\033[0m", colour_strings[colour], message);
+    if (length >= (i32)sizeof(out)) {
+        // Не влезло - пишем без цвета, содержимое важнее
+        linux_write_all(STDERR_FILENO, message, strlen(message));
+    } else {
+        linux_write_all(STDERR_FILENO, out, (u64)length);
+    }
+    pthread_mutex_unlock(&console_mutex);
+}
+
+//выталкивание консольного буфера
+void platform_console_flush() {
+    linux_console_flush();
+}
+
+//получение точного монотонного времени в секундах
+f64 platform_get_absolute_time() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (f64)now.tv_sec + (f64)now.tv_nsec * 0.000000001;
+}
+
+//поставить поток на паузу
+void platform_sleep(u64 ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000 * 1000;
+    // nanosleep прерывается сигналами - досыпаем оставшееся время
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+        if (quit_requested) {
+            break;
+        }
+    }
+}
+
+/* - потоки и синхронизация - */
+
+// Параметры запуска потока: pthread ждёт void*(*)(void*), а не u32(*)(void*)
+typedef struct linux_thread_start {
+    pfn_thread_start start;
+    void *params;
+} linux_thread_start;
+
+static void *linux_thread_entry(void *arg) {
+    linux_thread_start start = *(linux_thread_start *)arg;
+    free(arg);
+    return (void *)(u64)start.start(start.params);
+}
+
+//создание потока
+b8 platform_thread_create(pfn_thread_start start, void *params, platform_thread *out_thread) {
+    if (!start || !out_thread) {
+        return FALSE;
+    }
+    linux_thread_start *arg = malloc(sizeof(linux_thread_start));
+    arg->start = start;
+    arg->params = params;
+
+    pthread_t *thread = malloc(sizeof(pthread_t));
+    i32 result = pthread_create(thread, 0, linux_thread_entry, arg);
+    if (result != 0) {
+        KERROR("platform_thread_create - pthread_create failed: %s", strerror(result));
+        free(arg);
+        free(thread);
+        out_thread->internal_data = 0;
+        return FALSE;
+    }
+    out_thread->internal_data = thread;
+    return TRUE;
+}
+
+//ожидание завершения потока
+void platform_thread_join(platform_thread *thread) {
+    if (!thread || !thread->internal_data) {
+        return;
+    }
+    pthread_join(*(pthread_t *)thread->internal_data, 0);
+    free(thread->internal_data);
+    thread->internal_data = 0;
+}
+
+//уступить процессор
+void platform_thread_yield() {
+    sched_yield();
+}
+
+//привязка потока к процессорам
+b8 platform_thread_set_affinity(platform_thread *thread, u64 processor_mask) {
+    if (processor_mask == 0 || (thread && !thread->internal_data)) {
+        return FALSE;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (u32 i = 0; i < 64; ++i) {
+        if (processor_mask & (1ull << i)) {
+            CPU_SET(i, &set);
+        }
+    }
+    pthread_t handle = thread ? *(pthread_t *)thread->internal_data : pthread_self();
+    i32 result = pthread_setaffinity_np(handle, sizeof(set), &set);
+    if (result != 0) {
+        KWARN("platform_thread_set_affinity - pthread_setaffinity_np failed: %s", strerror(result));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+//количество логических процессоров
+u32 platform_get_processor_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+//размер кэш-линии
+u32 platform_get_cache_line_size() {
+    long size = 0;
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+    size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+#endif
+    if (size <= 0) {
+        // Не glibc или ядро не сообщило через sysconf - спрашиваем sysfs
+        FILE *file = fopen("/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size", "r");
+        if (file) {
+            if (fscanf(file, "%ld", &size) != 1) {
+                size = 0;
+            }
+            fclose(file);
+        }
+    }
+    return size > 0 ? (u32)size : PLATFORM_CACHE_LINE_SIZE;
+}
+
+//создание семафора
+b8 platform_semaphore_create(u32 initial_count, platform_semaphore *out_semaphore) {
+    sem_t *semaphore = malloc(sizeof(sem_t));
+    if (sem_init(semaphore, 0, initial_count) != 0) {
+        KERROR("platform_semaphore_create - sem_init failed: %s", strerror(errno));
+        free(semaphore);
+        out_semaphore->internal_data = 0;
+        return FALSE;
+    }
+    out_semaphore->internal_data = semaphore;
+    return TRUE;
+}
+
+//уничтожение семафора
+void platform_semaphore_destroy(platform_semaphore *semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return;
+    }
+    sem_destroy((sem_t *)semaphore->internal_data);
+    free(semaphore->internal_data);
+    semaphore->internal_data = 0;
+}
+
+//сигнал семафору
+void platform_semaphore_signal(platform_semaphore *semaphore) {
+    sem_post((sem_t *)semaphore->internal_data);
+}
+
+//ожидание сигнала с таймаутом
+b8 platform_semaphore_wait(platform_semaphore *semaphore, u64 timeout_ms) {
+    if (timeout_ms == PLATFORM_WAIT_INFINITE) {
+        while (sem_wait((sem_t *)semaphore->internal_data) != 0) {
+            if (errno != EINTR) {
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+    // sem_timedwait принимает абсолютное время по CLOCK_REALTIME
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    while (sem_timedwait((sem_t *)semaphore->internal_data, &deadline) != 0) {
+        if (errno != EINTR) {
+            return FALSE;  // ETIMEDOUT
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * Мьютекс и условная переменная на futex: пока нет борьбы за мьютекс,
+ * захват и освобождение - одна атомарная операция без вызова ядра.
+ * Слово мьютекса: 0 - свободен, 1 - захвачен, 2 - захвачен и, возможно,
+ * есть спящие (освобождающий должен разбудить одного).
+ * Слово условной переменной - счётчик сигналов.
+ */
+
+// Сколько раз захват пробует свободный мьютекс, прежде чем уснуть
+#define LINUX_MUTEX_SPIN_COUNT 100
+
+// Спит, пока *word == expected (и не дольше timeout_ms).
+// Возвращает FALSE только по истечении времени
+static b8 linux_futex_wait(atomic_u32 *word, u32 expected, u64 timeout_ms) {
+    struct timespec timeout;
+    struct timespec *timeout_ptr = 0;
+    if (timeout_ms != PLATFORM_WAIT_INFINITE) {
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = (timeout_ms % 1000) * 1000 * 1000;
+        timeout_ptr = &timeout;
+    }
+    // Относительный таймаут; EAGAIN (значение уже другое) и EINTR -
+    // обычные пробуждения
+    long result = syscall(SYS_futex, (u32 *)&word->value, FUTEX_WAIT_PRIVATE, expected, timeout_ptr, 0, 0);
+    return result == 0 || errno != ETIMEDOUT;
+}
+
+static void linux_futex_wake(atomic_u32 *word, i32 count) {
+    syscall(SYS_futex, (u32 *)&word->value, FUTEX_WAKE_PRIVATE, count, 0, 0, 0);
+}
+
+//захват мьютекса с пометкой "есть ожидающие" (медленный путь)
+static void linux_mutex_lock_contended(atomic_u32 *word) {
+    while (atomic_exchange_u32(word, 2, ATOMIC_ORDER_ACQUIRE) != 0) {
+        linux_futex_wait(word, 2, PLATFORM_WAIT_INFINITE);
+    }
+}
+
+//создание мьютекса
+void platform_mutex_create(platform_mutex *out_mutex) {
+    atomic_store_u32(&out_mutex->storage.word, 0, ATOMIC_ORDER_RELAXED);
+}
+
+//уничтожение мьютекса (ресурсов ядра у него нет)
+void platform_mutex_destroy(platform_mutex *mutex) {
+    atomic_store_u32(&mutex->storage.word, 0, ATOMIC_ORDER_RELAXED);
+}
+
+//захват мьютекса
+void platform_mutex_lock(platform_mutex *mutex) {
+    atomic_u32 *word = &mutex->storage.word;
+    u32 expected = 0;
+    if (atomic_compare_exchange_u32(word, &expected, 1, ATOMIC_ORDER_ACQUIRE, ATOMIC_ORDER_RELAXED)) {
+        return;
+    }
+    // Мьютекс обычно держат недолго: сначала ждём без вызова ядра
+    for (u32 i = 0; i < LINUX_MUTEX_SPIN_COUNT; ++i) {
+        atomic_spin_pause();
+        expected = 0;
+        if (atomic_load_u32(word, ATOMIC_ORDER_RELAXED) == 0 &&
+            atomic_compare_exchange_u32(word, &expected, 1, ATOMIC_ORDER_ACQUIRE, ATOMIC_ORDER_RELAXED)) {
+            return;
+        }
+    }
+    linux_mutex_lock_contended(word);
+}
+
+//попытка захвата мьютекса
+b8 platform_mutex_try_lock(platform_mutex *mutex) {
+    u32 expected = 0;
+    return atomic_compare_exchange_u32(&mutex->storage.word, &expected, 1,
+                                       ATOMIC_ORDER_ACQUIRE, ATOMIC_ORDER_RELAXED);
+}
+
+//освобождение мьютекса
+void platform_mutex_unlock(platform_mutex *mutex) {
+    atomic_u32 *word = &mutex->storage.word;
+    if (atomic_exchange_u32(word, 0, ATOMIC_ORDER_RELEASE) == 2) {
+        linux_futex_wake(word, 1);
+    }
+}
+
+//создание условной переменной
+void platform_condition_create(platform_condition *out_condition) {
+    atomic_store_u32(&out_condition->storage.word, 0, ATOMIC_ORDER_RELAXED);
+}
+
+//уничтожение условной переменной
+void platform_condition_destroy(platform_condition *condition) {
+    atomic_store_u32(&condition->storage.word, 0, ATOMIC_ORDER_RELAXED);
+}
+
+//ожидание условной переменной
+b8 platform_condition_wait(platform_condition *condition, platform_mutex *mutex, u64 timeout_ms) {
+    atomic_u32 *sequence = &condition->storage.word;
+    // Счётчик читается под мьютексом: сигнал после освобождения мьютекса
+    // изменит его, и futex не уснёт
+    u32 value = atomic_load_u32(sequence, ATOMIC_ORDER_ACQUIRE);
+    platform_mutex_unlock(mutex);
+    b8 signaled = linux_futex_wait(sequence, value, timeout_ms);
+    // Вместе с нами могли проснуться другие: захватываем как "есть ожидающие"
+    linux_mutex_lock_contended(&mutex->storage.word);
+    return signaled;
+}
+
+//сигнал одному ожидающему
+void platform_condition_signal(platform_condition *condition) {
+    atomic_u32 *sequence = &condition->storage.word;
+    atomic_fetch_add_u32(sequence, 1, ATOMIC_ORDER_RELEASE);
+    linux_futex_wake(sequence, 1);
+}
+
+//сигнал всем ожидающим
+void platform_condition_broadcast(platform_condition *condition) {
+    atomic_u32 *sequence = &condition->storage.word;
+    atomic_fetch_add_u32(sequence, 1, ATOMIC_ORDER_RELEASE);
+    linux_futex_wake(sequence, INT_MAX);
+}
+
+#endif // KPLATFORM_LINUX
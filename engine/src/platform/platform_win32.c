@@ -12,10 +12,12 @@
 #if KPLATFORM_WINDOWS
 
 #include "core/logger.h"
+#include "core/input.h"
 
 #include <windows.h>
 #include <windowsx.h>  // param input extraction
 #include <stdlib.h>
+#include <malloc.h>    // _aligned_malloc/_aligned_free
 
 typedef struct internal_state {
     HINSTANCE h_instance;  //дескриптор экземпляра приложения, который используется Windows API для идентификации процесса.
@@ -154,6 +156,13 @@ b8 platform_startup(
     //получаем текущее значение счетчика при запуске
     QueryPerformanceCounter(&start_time);
 
+    u32 cache_line_size = platform_get_cache_line_size();
+    KINFO("%u logical processor(s), %u-byte cache line.", platform_get_processor_count(), cache_line_size);
+    if (cache_line_size > PLATFORM_CACHE_LINE_SIZE) {
+        KWARN("Cache line is larger than PLATFORM_CACHE_LINE_SIZE (%u): per-thread data may share lines.",
+              PLATFORM_CACHE_LINE_SIZE);
+    }
+
     return TRUE;
 }
 
@@ -209,14 +218,47 @@ b8 platform_pump_messages(platform_state *plat_state) {
 
 //выделение памяти
 void *platform_allocate(u64 size, b8 aligned) {
+    if (aligned) {
+        return platform_allocate_aligned(size, PLATFORM_DEFAULT_ALIGNMENT);
+    }
     return malloc(size);
 }
 
+//выделение выровненной памяти
+void *platform_allocate_aligned(u64 size, u64 alignment) {
+    return _aligned_malloc(size, alignment);
+}
+
+//выделение обнулённой памяти
+void *platform_allocate_zeroed(u64 size, b8 aligned) {
+    if (aligned) {
+        // Выровненного calloc нет - обнуляем сами
+        void *block = platform_allocate_aligned(size, PLATFORM_DEFAULT_ALIGNMENT);
+        return block ? memset(block, 0, size) : 0;
+    }
+    return calloc(1, size);
+}
+
+//изменение размера блока (без выравнивания)
+void *platform_reallocate(void *block, u64 new_size) {
+    return realloc(block, new_size);
+}
+
 //освобождение памяти 
 void platform_free(void *block, b8 aligned) {
+    // Блоки _aligned_malloc нельзя отдавать в free
+    if (aligned) {
+        _aligned_free(block);
+        return;
+    }
     free(block);
 }
 
+//освобождение выровненной памяти
+void platform_free_aligned(void *block) {
+    _aligned_free(block);
+}
+
 //обнуление памяти 
 void *platform_zero_memory(void *block, u64 size) {
     return memset(block, 0, size);
@@ -227,6 +269,11 @@ void *platform_copy_memory(void *dest, const void *source, u64 size) {
     return memcpy(dest, source, size);
 }
 
+//копирование пересекающихся областей
+void *platform_move_memory(void *dest, const void *source, u64 size) {
+    return memmove(dest, source, size);
+}
+
 //заполнение значением памяти 
 void *platform_set_memory(void *dest, i32 value, u64 size) {
     return memset(dest, value, size);
@@ -316,6 +363,193 @@ void platform_sleep(u64 ms) {
     Sleep(ms);
 }
 
+//консольный вывод не буферизуется - выталкивать нечего
+void platform_console_flush() {
+}
+
+/* - потоки и синхронизация - */
+
+// Параметры запуска потока: CreateThread ждёт DWORD WINAPI (*)(LPVOID)
+typedef struct win32_thread_start {
+    pfn_thread_start start;
+    void *params;
+} win32_thread_start;
+
+static DWORD WINAPI win32_thread_entry(LPVOID arg) {
+    win32_thread_start start = *(win32_thread_start *)arg;
+    free(arg);
+    return (DWORD)start.start(start.params);
+}
+
+//уступить процессор
+void platform_thread_yield() {
+    SwitchToThread();
+}
+
+//привязка потока к процессорам
+b8 platform_thread_set_affinity(platform_thread *thread, u64 processor_mask) {
+    if (processor_mask == 0 || (thread && !thread->internal_data)) {
+        return FALSE;
+    }
+    HANDLE handle = thread ? (HANDLE)thread->internal_data : GetCurrentThread();
+    if (!SetThreadAffinityMask(handle, (DWORD_PTR)processor_mask)) {
+        KWARN("platform_thread_set_affinity - SetThreadAffinityMask failed: %lu", GetLastError());
+        return FALSE;
+    }
+    return TRUE;
+}
+
+//количество логических процессоров
+u32 platform_get_processor_count() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (u32)info.dwNumberOfProcessors : 1;
+}
+
+//размер кэш-линии (по описанию кэша данных L1)
+u32 platform_get_cache_line_size() {
+    u32 line_size = 0;
+    DWORD length = 0;
+    GetLogicalProcessorInformation(0, &length);
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION *info = malloc(length);
+    if (info && GetLogicalProcessorInformation(info, &length)) {
+        u32 count = length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+        for (u32 i = 0; i < count; ++i) {
+            if (info[i].Relationship == RelationCache && info[i].Cache.Level == 1 &&
+                info[i].Cache.Type != CacheInstruction) {
+                line_size = info[i].Cache.LineSize;
+                break;
+            }
+        }
+    }
+    free(info);
+    return line_size > 0 ? line_size : PLATFORM_CACHE_LINE_SIZE;
+}
+
+//создание потока
+b8 platform_thread_create(pfn_thread_start start, void *params, platform_thread *out_thread) {
+    if (!start || !out_thread) {
+        return FALSE;
+    }
+    win32_thread_start *arg = malloc(sizeof(win32_thread_start));
+    arg->start = start;
+    arg->params = params;
+
+    HANDLE thread = CreateThread(0, 0, win32_thread_entry, arg, 0, 0);
+    if (!thread) {
+        KERROR("platform_thread_create - CreateThread failed: %lu", GetLastError());
+        free(arg);
+        out_thread->internal_data = 0;
+        return FALSE;
+    }
+    out_thread->internal_data = thread;
+    return TRUE;
+}
+
+//ожидание завершения потока
+void platform_thread_join(platform_thread *thread) {
+    if (!thread || !thread->internal_data) {
+        return;
+    }
+    WaitForSingleObject((HANDLE)thread->internal_data, INFINITE);
+    CloseHandle((HANDLE)thread->internal_data);
+    thread->internal_data = 0;
+}
+
+//создание семафора
+b8 platform_semaphore_create(u32 initial_count, platform_semaphore *out_semaphore) {
+    HANDLE semaphore = CreateSemaphoreA(0, initial_count, 0x7FFFFFFF, 0);
+    if (!semaphore) {
+        KERROR("platform_semaphore_create - CreateSemaphore failed: %lu", GetLastError());
+        out_semaphore->internal_data = 0;
+        return FALSE;
+    }
+    out_semaphore->internal_data = semaphore;
+    return TRUE;
+}
+
+//уничтожение семафора
+void platform_semaphore_destroy(platform_semaphore *semaphore) {
+    if (!semaphore || !semaphore->internal_data) {
+        return;
+    }
+    CloseHandle((HANDLE)semaphore->internal_data);
+    semaphore->internal_data = 0;
+}
+
+//сигнал семафору
+void platform_semaphore_signal(platform_semaphore *semaphore) {
+    ReleaseSemaphore((HANDLE)semaphore->internal_data, 1, 0);
+}
+
+//ожидание сигнала с таймаутом
+b8 platform_semaphore_wait(platform_semaphore *semaphore, u64 timeout_ms) {
+    DWORD timeout = timeout_ms >= INFINITE ? INFINITE : (DWORD)timeout_ms;
+    return WaitForSingleObject((HANDLE)semaphore->internal_data, timeout) == WAIT_OBJECT_0;
+}
+
+/*
+ * Мьютекс - SRWLOCK, условная переменная - CONDITION_VARIABLE. Оба размером
+ * в указатель и хранятся прямо в storage.pointer; нулевое значение -
+ * их начальное состояние (SRWLOCK_INIT, CONDITION_VARIABLE_INIT).
+ */
+STATIC_ASSERT(sizeof(SRWLOCK) == sizeof(void *), "SRWLOCK must fit platform_sync_storage.");
+STATIC_ASSERT(sizeof(CONDITION_VARIABLE) == sizeof(void *), "CONDITION_VARIABLE must fit platform_sync_storage.");
+
+//создание мьютекса
+void platform_mutex_create(platform_mutex *out_mutex) {
+    InitializeSRWLock((PSRWLOCK)&out_mutex->storage.pointer);
+}
+
+//уничтожение мьютекса (ресурсов ядра у SRWLOCK нет)
+void platform_mutex_destroy(platform_mutex *mutex) {
+    mutex->storage.pointer = 0;
+}
+
+//захват мьютекса
+void platform_mutex_lock(platform_mutex *mutex) {
+    AcquireSRWLockExclusive((PSRWLOCK)&mutex->storage.pointer);
+}
+
+//попытка захвата мьютекса
+b8 platform_mutex_try_lock(platform_mutex *mutex) {
+    return TryAcquireSRWLockExclusive((PSRWLOCK)&mutex->storage.pointer) ? TRUE : FALSE;
+}
+
+//освобождение мьютекса
+void platform_mutex_unlock(platform_mutex *mutex) {
+    ReleaseSRWLockExclusive((PSRWLOCK)&mutex->storage.pointer);
+}
+
+//создание условной переменной
+void platform_condition_create(platform_condition *out_condition) {
+    InitializeConditionVariable((PCONDITION_VARIABLE)&out_condition->storage.pointer);
+}
+
+//уничтожение условной переменной
+void platform_condition_destroy(platform_condition *condition) {
+    condition->storage.pointer = 0;
+}
+
+//ожидание условной переменной
+b8 platform_condition_wait(platform_condition *condition, platform_mutex *mutex, u64 timeout_ms) {
+    DWORD timeout = timeout_ms >= INFINITE ? INFINITE : (DWORD)timeout_ms;
+    return SleepConditionVariableSRW((PCONDITION_VARIABLE)&condition->storage.pointer,
+                                     (PSRWLOCK)&mutex->storage.pointer, timeout, 0)
+               ? TRUE
+               : FALSE;
+}
+
+//сигнал одному ожидающему
+void platform_condition_signal(platform_condition *condition) {
+    WakeConditionVariable((PCONDITION_VARIABLE)&condition->storage.pointer);
+}
+
+//сигнал всем ожидающим
+void platform_condition_broadcast(platform_condition *condition) {
+    WakeAllConditionVariable((PCONDITION_VARIABLE)&condition->storage.pointer);
+}
+
 //оконная процедура(это callback которую windows вызывает на каждое сообщение для окна  
 LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARAM l_param) {
     switch (msg) {
@@ -342,23 +576,23 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
         case WM_KEYUP:
         case WM_SYSKEYUP: {
             // Key pressed/released
-            //b8 pressed = (msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN);
-            // TODO: input processing
-
+            b8 pressed = (msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN);
+            keys key = (u16)w_param;
+            input_process_key(key, pressed);
         } break;
         case WM_MOUSEMOVE: {
             // Mouse move
-            //i32 x_position = GET_X_LPARAM(l_param);
-            //i32 y_position = GET_Y_LPARAM(l_param);
-            // TODO: input processing.
+            i32 x_position = GET_X_LPARAM(l_param);
+            i32 y_position = GET_Y_LPARAM(l_param);
+            input_process_mouse_move((i16)x_position, (i16)y_position);
         } break;
         case WM_MOUSEWHEEL: {
-            // i32 z_delta = GET_WHEEL_DELTA_WPARAM(w_param);
-            // if (z_delta != 0) {
-            //     // Flatten the input to an OS-independent (-1, 1)
-            //     z_delta = (z_delta < 0) ? -1 : 1;
-            //     // TODO: input processing.
-            // }
+            i32 z_delta = GET_WHEEL_DELTA_WPARAM(w_param);
+            if (z_delta != 0) {
+                // Flatten the input to an OS-independent (-1, 1)
+                z_delta = (z_delta < 0) ? -1 : 1;
+                input_process_mouse_wheel((i8)z_delta);
+            }
         } break;
         case WM_LBUTTONDOWN:
         case WM_MBUTTONDOWN:
@@ -366,8 +600,25 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
         case WM_LBUTTONUP:
         case WM_MBUTTONUP:
         case WM_RBUTTONUP: {
-            //b8 pressed = msg == WM_LBUTTONDOWN || msg == WM_RBUTTONDOWN || msg == WM_MBUTTONDOWN;
-            // TODO: input processing.
+            b8 pressed = msg == WM_LBUTTONDOWN || msg == WM_RBUTTONDOWN || msg == WM_MBUTTONDOWN;
+            buttons mouse_button = BUTTON_MAX_BUTTONS;
+            switch (msg) {
+                case WM_LBUTTONDOWN:
+                case WM_LBUTTONUP:
+                    mouse_button = BUTTON_LEFT;
+                    break;
+                case WM_MBUTTONDOWN:
+                case WM_MBUTTONUP:
+                    mouse_button = BUTTON_MIDDLE;
+                    break;
+                case WM_RBUTTONDOWN:
+                case WM_RBUTTONUP:
+                    mouse_button = BUTTON_RIGHT;
+                    break;
+            }
+            if (mouse_button != BUTTON_MAX_BUTTONS) {
+                input_process_button(mouse_button, pressed);
+            }
         } break;
     }
 
@@ -14,7 +14,7 @@ compilerFlags="-g -fdeclspec -fPIC"
 # -fms-extensions 
 # -Wall -Werror
 includeFlags="-Isrc -I../engine/src/"
-linkerFlags="-L../bin/ -lengine -Wl,-rpath,."
+linkerFlags="-L../bin/ -lengine -Wl,-rpath,. -pthread"
 defines="-D_DEBUG -DKIMPORT"
 
 echo "Building $assembly..."
@@ -24,6 +24,9 @@ b8 create_game(game* out_game) {
  out_game->app_config.start_width = 1280;
  out_game->app_config.start_height = 720;
  out_game->app_config.name = "Kohi Engine Testbed";
+ //симуляция шагами по 1/60 с, не больше 60 кадров в секунду
+ out_game->app_config.fixed_update = TRUE;
+ out_game->app_config.target_frame_rate = 60;
  out_game->update = game_update;
  out_game->render = game_render;
  out_game->initialize = game_initialize;
@@ -17,7 +17,7 @@ b8 game_update(game* game_inst, f32 delta_time) {
 }
 
 //отрисовка
-b8 game_render(game* game_inst, f32 delta_time) {
+b8 game_render(game* game_inst, f32 delta_time, f32 alpha) {
     return TRUE;
 }
 
@@ -17,8 +17,8 @@ b8 game_initialize(game* game_inst);
 //обновление игры
 b8 game_update(game* game_inst, f32 delta_time);
 
-//отрисовка
-b8 game_render(game* game_inst, f32 delta_time);
+//отрисовка (alpha - доля шага симуляции для интерполяции)
+b8 game_render(game* game_inst, f32 delta_time, f32 alpha);
 
 //изменение размера окна игры
 void game_on_resize(game* game_inst, u32 width, u32 height);
\ No newline at end of file
@@ -0,0 +1,148 @@
+/*
+   Стресс-бенчмарк потокобезопасной отправки событий.
+
+   N потоков-производителей шлют события через event_post_threadsafe,
+   главный поток разбирает их через event_dispatch_queued, как это делает
+   application_run. Выводит пропускную способность и задержку доставки
+   (от постановки до вызова обработчика): p50/p99/p99.9/max.
+
+   Запуск: event_bench [producers] [events_per_producer]
+*/
+
+#include <defines.h>
+#include <core/event.h>
+#include <core/kmemory.h>
+#include <platform/atomic.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Код события бенчмарка (пользовательский диапазон)
+#define BENCH_EVENT_CODE 0x100
+
+typedef struct producer_args {
+    u32 id;
+    u32 count;
+    u64 full_retries;  // сколько раз очередь оказалась заполнена
+} producer_args;
+
+typedef struct bench_state {
+    f64* latencies;      // задержка каждого доставленного события, секунды
+    u64 received;
+    u32* next_sequence;  // ожидаемый номер следующего события по производителю
+    u64 order_errors;
+    atomic_u32 start;
+} bench_state;
+
+static bench_state bench;
+
+//время в формате, который помещается в u64 контекста
+static inline u64 now_ns() {
+    return (u64)(platform_get_absolute_time() * 1000000000.0);
+}
+
+//обработчик: считает задержку и проверяет порядок событий производителя
+static b8 on_bench_event(u16 code, void* sender, void* listener_inst, event_context data) {
+    u64 sent = data.data.u64[0];
+    u32 producer = data.data.u32[2];
+    u32 sequence = data.data.u32[3];
+    bench.latencies[bench.received++] = (f64)(now_ns() - sent) * 0.000000001;
+    if (bench.next_sequence[producer] != sequence) {
+        bench.order_errors++;
+    }
+    bench.next_sequence[producer] = sequence + 1;
+    return TRUE;
+}
+
+//поток-производитель
+static u32 producer_main(void* arg) {
+    producer_args* args = (producer_args*)arg;
+    while (!atomic_load_u32(&bench.start, ATOMIC_ORDER_ACQUIRE)) {
+    }
+    for (u32 i = 0; i < args->count; ++i) {
+        event_context context;
+        context.data.u32[2] = args->id;
+        context.data.u32[3] = i;
+        context.data.u64[0] = now_ns();
+        while (!event_post_threadsafe(BENCH_EVENT_CODE, 0, context)) {
+            // Очередь заполнена - ждём, пока главный поток её разберёт
+            args->full_retries++;
+            context.data.u64[0] = now_ns();
+        }
+    }
+    return 0;
+}
+
+static int compare_f64(const void* a, const void* b) {
+    f64 x = *(const f64*)a;
+    f64 y = *(const f64*)b;
+    return (x > y) - (x < y);
+}
+
+static f64 percentile(f64* sorted, u64 count, f64 p) {
+    u64 index = (u64)(p * (f64)(count - 1));
+    return sorted[index];
+}
+
+int main(int argc, char** argv) {
+    u32 producers = argc > 1 ? (u32)atoi(argv[1]) : 4;
+    u32 per_producer = argc > 2 ? (u32)atoi(argv[2]) : 1000000;
+    u64 total = (u64)producers * per_producer;
+
+    initialize_memory();
+    if (!event_initialize()) {
+        printf("event_initialize failed\n");
+        return 1;
+    }
+    event_register(BENCH_EVENT_CODE, 0, on_bench_event);
+
+    bench.latencies = malloc(sizeof(f64) * total);
+    bench.next_sequence = calloc(producers, sizeof(u32));
+
+    platform_thread* threads = malloc(sizeof(platform_thread) * producers);
+    producer_args* args = calloc(producers, sizeof(producer_args));
+    for (u32 i = 0; i < producers; ++i) {
+        args[i].id = i;
+        args[i].count = per_producer;
+        if (!platform_thread_create(producer_main, &args[i], &threads[i])) {
+            printf("platform_thread_create failed\n");
+            return 1;
+        }
+    }
+
+    f64 start_time = platform_get_absolute_time();
+    atomic_store_u32(&bench.start, TRUE, ATOMIC_ORDER_RELEASE);
+
+    // Главный поток: разбор очереди, как в цикле кадра
+    u64 batches = 0;
+    while (bench.received < total) {
+        if (event_dispatch_queued() > 0) {
+            batches++;
+        }
+    }
+    f64 elapsed = platform_get_absolute_time() - start_time;
+
+    u64 full_retries = 0;
+    for (u32 i = 0; i < producers; ++i) {
+        platform_thread_join(&threads[i]);
+        full_retries += args[i].full_retries;
+    }
+
+    qsort(bench.latencies, total, sizeof(f64), compare_f64);
+    printf("producers: %u, events: %llu, batches: %llu\n", producers, total, batches);
+    printf("throughput: %.2f M events/s (%.3f s)\n", (f64)total / elapsed / 1000000.0, elapsed);
+    printf("latency us: p50 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+           percentile(bench.latencies, total, 0.5) * 1000000.0,
+           percentile(bench.latencies, total, 0.99) * 1000000.0,
+           percentile(bench.latencies, total, 0.999) * 1000000.0,
+           bench.latencies[total - 1] * 1000000.0);
+    printf("queue full retries: %llu, order errors: %llu\n", full_retries, bench.order_errors);
+
+    event_shutdown();
+    free(threads);
+    free(args);
+    free(bench.latencies);
+    free(bench.next_sequence);
+    return bench.order_errors == 0 ? 0 : 1;
+}
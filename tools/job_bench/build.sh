@@ -0,0 +1,17 @@
+#!/bin/bash
+# Build script for job_bench (Linux)
+set echo on
+
+mkdir -p ../../bin
+
+# Get a list of all the .c files.
+cFilenames=$(find . -type f -name "*.c")
+
+assembly="job_bench"
+compilerFlags="-g -O2 -fPIC"
+includeFlags="-Isrc -I../../engine/src/"
+linkerFlags="-L../../bin/ -lengine -lpthread -Wl,-rpath,."
+defines="-DKIMPORT"
+
+echo "Building $assembly..."
+clang $cFilenames $compilerFlags -o ../../bin/$assembly $defines $includeFlags $linkerFlags
@@ -0,0 +1,194 @@
+/*
+   Стресс-тест системы задач.
+
+   Каждый раунд:
+     1. Плоская пачка: главный поток ставит задачи больше, чем вмещает дек
+        (часть выполняется сразу), каждая отмечает свою ячейку.
+     2. Дерево: задача-узел ставит дочерние задачи со своим счётчиком и
+        ждёт их (job_system_wait внутри задачи), листья отмечают свои ячейки.
+     3. Нагрузка: задачи с вычислениями - пропускная способность.
+   После раунда каждая ячейка должна быть отмечена ровно один раз, а
+   результаты вычислений - совпасть с посчитанными в одном потоке.
+
+   Запуск: job_bench [workers] [rounds]   (workers 0 - по числу ядер)
+*/
+
+#include <defines.h>
+#include <core/job_system.h>
+#include <core/kmemory.h>
+#include <platform/atomic.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Плоская пачка (больше ёмкости дека - 4096)
+#define BENCH_FLAT_JOBS 20000
+
+// Дерево: ветвление и глубина (листьев BENCH_TREE_FANOUT^BENCH_TREE_DEPTH)
+#define BENCH_TREE_FANOUT 8
+#define BENCH_TREE_DEPTH 5
+#define BENCH_TREE_LEAVES (8 * 8 * 8 * 8 * 8)
+
+// Задачи с вычислениями
+#define BENCH_WORK_JOBS 4096
+#define BENCH_WORK_ITERATIONS 20000
+
+typedef struct tree_node {
+    u32 depth;
+    u32 first_leaf;  // номер первого листа поддерева
+} tree_node;
+
+typedef struct bench_state {
+    atomic_u32 flat_hits[BENCH_FLAT_JOBS];
+    atomic_u32 leaf_hits[BENCH_TREE_LEAVES];
+    atomic_u32 nodes_run;
+    u64 work_results[BENCH_WORK_JOBS];
+} bench_state;
+
+static bench_state bench;
+
+static void flat_job(void* param) {
+    atomic_fetch_add_u32(&bench.flat_hits[(u64)param], 1, ATOMIC_ORDER_RELAXED);
+}
+
+//узел дерева: лист отмечает себя, иначе ставит детей и ждёт их
+static void tree_job(void* param) {
+    tree_node* node = (tree_node*)param;
+    atomic_fetch_add_u32(&bench.nodes_run, 1, ATOMIC_ORDER_RELAXED);
+    if (node->depth == BENCH_TREE_DEPTH) {
+        atomic_fetch_add_u32(&bench.leaf_hits[node->first_leaf], 1, ATOMIC_ORDER_RELAXED);
+        return;
+    }
+    u32 leaves_per_child = 1;
+    for (u32 d = node->depth + 1; d < BENCH_TREE_DEPTH; ++d) {
+        leaves_per_child *= BENCH_TREE_FANOUT;
+    }
+    // Дети живут на стеке: узел не завершится, пока они не выполнены
+    tree_node children[BENCH_TREE_FANOUT];
+    job_desc jobs[BENCH_TREE_FANOUT];
+    for (u32 i = 0; i < BENCH_TREE_FANOUT; ++i) {
+        children[i].depth = node->depth + 1;
+        children[i].first_leaf = node->first_leaf + i * leaves_per_child;
+        jobs[i].entry = tree_job;
+        jobs[i].param = &children[i];
+    }
+    job_counter counter = {0};
+    job_system_submit(jobs, BENCH_TREE_FANOUT, &counter);
+    job_system_wait(&counter);
+}
+
+//вычисление, которое нельзя выбросить: xorshift от номера задачи
+static u64 work_compute(u64 index) {
+    u64 x = index * 0x9E3779B97F4A7C15ull + 1;
+    for (u32 i = 0; i < BENCH_WORK_ITERATIONS; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+static void work_job(void* param) {
+    u64 index = (u64)param;
+    bench.work_results[index] = work_compute(index);
+}
+
+//ставит count задач entry с параметрами 0..count-1 и ждёт их
+static void run_indexed(pfn_job_entry entry, u32 count) {
+    static job_desc jobs[BENCH_FLAT_JOBS];
+    for (u32 i = 0; i < count; ++i) {
+        jobs[i].entry = entry;
+        jobs[i].param = (void*)(u64)i;
+    }
+    job_counter counter = {0};
+    job_system_submit(jobs, count, &counter);
+    job_system_wait(&counter);
+}
+
+int main(int argc, char** argv) {
+    u32 workers = argc > 1 ? (u32)atoi(argv[1]) : 0;
+    u32 rounds = argc > 2 ? (u32)atoi(argv[2]) : 20;
+
+    initialize_memory();
+    if (!job_system_initialize(workers)) {
+        printf("job_system_initialize failed\n");
+        return 1;
+    }
+    workers = job_system_worker_count();
+
+    // Эталон вычислений - в одном потоке, через ту же work_job, что и задачи,
+    // чтобы сравнение времени не зависело от встраивания цикла компилятором
+    u64* expected = malloc(sizeof(u64) * BENCH_WORK_JOBS);
+    pfn_job_entry volatile serial_entry = work_job;
+    f64 serial_start = platform_get_absolute_time();
+    for (u32 i = 0; i < BENCH_WORK_JOBS; ++i) {
+        serial_entry((void*)(u64)i);
+    }
+    f64 serial_time = platform_get_absolute_time() - serial_start;
+    for (u32 i = 0; i < BENCH_WORK_JOBS; ++i) {
+        expected[i] = bench.work_results[i];
+        bench.work_results[i] = 0;
+    }
+
+    u32 tree_nodes = 0;
+    for (u32 d = 0, level = 1; d <= BENCH_TREE_DEPTH; ++d, level *= BENCH_TREE_FANOUT) {
+        tree_nodes += level;
+    }
+
+    u64 errors = 0;
+    f64 flat_time = 0;
+    f64 tree_time = 0;
+    f64 work_time = 0;
+    for (u32 round = 0; round < rounds; ++round) {
+        f64 start = platform_get_absolute_time();
+        run_indexed(flat_job, BENCH_FLAT_JOBS);
+        flat_time += platform_get_absolute_time() - start;
+
+        start = platform_get_absolute_time();
+        tree_node root = {0, 0};
+        job_desc root_job = {tree_job, &root};
+        job_counter counter = {0};
+        job_system_submit(&root_job, 1, &counter);
+        job_system_wait(&counter);
+        tree_time += platform_get_absolute_time() - start;
+
+        start = platform_get_absolute_time();
+        run_indexed(work_job, BENCH_WORK_JOBS);
+        work_time += platform_get_absolute_time() - start;
+
+        // Проверка раунда
+        for (u32 i = 0; i < BENCH_FLAT_JOBS; ++i) {
+            if (atomic_load_u32(&bench.flat_hits[i], ATOMIC_ORDER_RELAXED) != round + 1) {
+                errors++;
+            }
+        }
+        for (u32 i = 0; i < BENCH_TREE_LEAVES; ++i) {
+            if (atomic_load_u32(&bench.leaf_hits[i], ATOMIC_ORDER_RELAXED) != round + 1) {
+                errors++;
+            }
+        }
+        if (atomic_load_u32(&bench.nodes_run, ATOMIC_ORDER_RELAXED) != (round + 1) * tree_nodes) {
+            errors++;
+        }
+        for (u32 i = 0; i < BENCH_WORK_JOBS; ++i) {
+            if (bench.work_results[i] != expected[i]) {
+                errors++;
+            }
+            bench.work_results[i] = 0;
+        }
+    }
+
+    printf("workers: %u, rounds: %u\n", workers, rounds);
+    printf("flat:  %u jobs/round, %.2f M jobs/s\n", BENCH_FLAT_JOBS,
+           (f64)BENCH_FLAT_JOBS * rounds / flat_time / 1000000.0);
+    printf("tree:  %u nodes/round (fan-out %u, depth %u), %.2f M jobs/s\n", tree_nodes, BENCH_TREE_FANOUT,
+           BENCH_TREE_DEPTH, (f64)tree_nodes * rounds / tree_time / 1000000.0);
+    printf("work:  %u jobs/round, %.3f ms/round (single thread %.3f ms, speedup %.2fx)\n", BENCH_WORK_JOBS,
+           work_time * 1000.0 / rounds, serial_time * 1000.0, serial_time * rounds / work_time);
+    printf("errors: %llu\n", errors);
+
+    job_system_shutdown();
+    free(expected);
+    return errors == 0 ? 0 : 1;
+}
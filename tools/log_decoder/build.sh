@@ -0,0 +1,17 @@
+#!/bin/bash
+# Build script for log_decoder (Linux)
+set echo on
+
+mkdir -p ../../bin
+
+# Get a list of all the .c files.
+cFilenames=$(find . -type f -name "*.c")
+
+assembly="log_decoder"
+compilerFlags="-g -O2 -fPIC"
+includeFlags="-Isrc -I../../engine/src/"
+linkerFlags=""
+defines=""
+
+echo "Building $assembly..."
+clang $cFilenames $compilerFlags -o ../../bin/$assembly $defines $includeFlags $linkerFlags
@@ -0,0 +1,330 @@
+/*
+   Декодер двоичного лога (core/logger_binary.c).
+
+   Читает файл целиком, сначала собирает все записи форматов (поток мог
+   записать формат позже, чем другой поток - сообщение с ним), затем
+   разбирает сообщения, упорядочивает их по времени и печатает текстом:
+
+     [DEBUG] 12.345678 t0: сообщение
+
+   Время - секунды монотонных часов платформы, t<N> - номер потока в логе.
+
+   Запуск: log_decoder <file.kblg> [--unsorted]
+*/
+
+#include <defines.h>
+#include <core/logger_binary_format.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Разобранная запись формата
+typedef struct decoded_format {
+    const char* text;  // строка формата в буфере файла (без завершающего нуля)
+    u16 length;
+    u8 level;
+    u8 arg_count;
+    const u8* arg_types;
+} decoded_format;
+
+// Запись сообщения в буфере файла
+typedef struct decoded_message {
+    u64 timestamp_ns;
+    u64 offset;  // смещение записи; порядок внутри одного времени
+} decoded_message;
+
+static const char* level_names[6] = {"FATAL", "ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+
+//чтение значений из невыровненного буфера
+static u16 read_u16(const u8* at) { u16 v; memcpy(&v, at, 2); return v; }
+static u32 read_u32(const u8* at) { u32 v; memcpy(&v, at, 4); return v; }
+static u64 read_u64(const u8* at) { u64 v; memcpy(&v, at, 8); return v; }
+
+//загружает файл целиком
+static u8* load_file(const char* path, u64* out_size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot open '%s'.\n", path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    u8* data = malloc(size > 0 ? size : 1);
+    if (size < 0 || fread(data, 1, size, file) != (size_t)size) {
+        fprintf(stderr, "Cannot read '%s'.\n", path);
+        free(data);
+        fclose(file);
+        return 0;
+    }
+    fclose(file);
+    *out_size = (u64)size;
+    return data;
+}
+
+//размер записи по смещению offset; 0 - запись обрезана или повреждена
+static u64 record_size(const u8* data, u64 size, u64 offset) {
+    u64 left = size - offset;
+    switch (data[offset]) {
+        case LOG_BINARY_RECORD_FORMAT: {
+            if (left < 8) {
+                return 0;
+            }
+            u64 length = read_u16(data + offset + 6);
+            if (left < 8 + length + 1) {
+                return 0;
+            }
+            u64 total = 8 + length + 1 + data[offset + 8 + length];
+            return total <= left ? total : 0;
+        }
+        case LOG_BINARY_RECORD_MESSAGE: {
+            if (left < LOG_BINARY_MESSAGE_HEADER_SIZE) {
+                return 0;
+            }
+            u64 total = LOG_BINARY_MESSAGE_HEADER_SIZE + read_u16(data + offset + 15);
+            return total <= left ? total : 0;
+        }
+    }
+    return 0;
+}
+
+//упорядочивает по времени, при равенстве - по положению в файле
+static int compare_messages(const void* a, const void* b) {
+    const decoded_message* left = a;
+    const decoded_message* right = b;
+    if (left->timestamp_ns != right->timestamp_ns) {
+        return left->timestamp_ns < right->timestamp_ns ? -1 : 1;
+    }
+    return left->offset < right->offset ? -1 : (left->offset > right->offset ? 1 : 0);
+}
+
+//выводит кусок строки формата без спецификаторов ("%%" -> "%")
+static void print_literal(const char* start, const char* end) {
+    for (const char* p = start; p < end; ++p) {
+        if (p[0] == '%' && p + 1 < end && p[1] == '%') {
+            ++p;
+        }
+        fputc(*p, stdout);
+    }
+}
+
+/*
+ * Собирает спецификатор заново для printf этой сборки: модификаторы длины
+ * отбрасываются и заменяются на соответствующие записанному типу.
+ */
+static void rebuild_spec(const log_binary_spec* spec, char* out, u64 out_size) {
+    u64 n = 0;
+    for (const char* p = spec->start; p < spec->end - 1 && n + 4 < out_size; ++p) {
+        if (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't' || *p == 'L') {
+            continue;
+        }
+        out[n++] = *p;
+    }
+    if (spec->type == LOG_ARG_I64) {
+        out[n++] = 'l';
+        out[n++] = 'l';
+    }
+    out[n++] = spec->conversion;
+    out[n] = 0;
+}
+
+//печатает одно сообщение; FALSE - данные не совпали с форматом
+static b8 print_message(const decoded_format* format, u32 thread, u64 timestamp_ns, const u8* payload, u64 payload_size) {
+    const char* level = format->level < 6 ? level_names[format->level] : "?";
+    printf("[%s] %.6f t%u: ", level, (f64)timestamp_ns * 0.000000001, thread);
+
+    // Строка формата в файле без завершающего нуля
+    char text[0x10000];
+    memcpy(text, format->text, format->length);
+    text[format->length] = 0;
+
+    const u8* at = payload;
+    const u8* end = payload + payload_size;
+    const char* cursor = text;
+    u8 arg = 0;
+    log_binary_spec spec;
+    while (log_binary_next_spec(cursor, &spec) == 1) {
+        print_literal(cursor, spec.start);
+        cursor = spec.end;
+
+        // Ширина и точность через '*'
+        int stars[2] = {0, 0};
+        for (u8 i = 0; i < spec.star_count; ++i) {
+            if (arg >= format->arg_count || end - at < 4) {
+                return FALSE;
+            }
+            stars[i] = (int)read_u32(at);
+            at += 4;
+            arg++;
+        }
+        if (arg >= format->arg_count || format->arg_types[arg] != spec.type) {
+            return FALSE;
+        }
+        arg++;
+
+        char spec_text[64];
+        rebuild_spec(&spec, spec_text, sizeof(spec_text));
+
+        // Значение по типу; printf вызывается с нужным числом звёздочек
+#define PRINT_VALUE(value)                                              \
+    if (spec.star_count == 0) {                                         \
+        printf(spec_text, value);                                       \
+    } else if (spec.star_count == 1) {                                  \
+        printf(spec_text, stars[0], value);                             \
+    } else {                                                            \
+        printf(spec_text, stars[0], stars[1], value);                   \
+    }
+
+        switch (spec.type) {
+            case LOG_ARG_I32: {
+                if (end - at < 4) {
+                    return FALSE;
+                }
+                i32 value = (i32)read_u32(at);
+                at += 4;
+                PRINT_VALUE(value);
+            } break;
+            case LOG_ARG_I64: {
+                if (end - at < 8) {
+                    return FALSE;
+                }
+                long long value = (long long)read_u64(at);
+                at += 8;
+                PRINT_VALUE(value);
+            } break;
+            case LOG_ARG_F64: {
+                if (end - at < 8) {
+                    return FALSE;
+                }
+                f64 value;
+                memcpy(&value, at, 8);
+                at += 8;
+                PRINT_VALUE(value);
+            } break;
+            case LOG_ARG_PTR: {
+                if (end - at < 8) {
+                    return FALSE;
+                }
+                void* value = (void*)(uintptr_t)read_u64(at);
+                at += 8;
+                PRINT_VALUE(value);
+            } break;
+            case LOG_ARG_STR: {
+                if (end - at < 2 || (u64)(end - at - 2) < read_u16(at)) {
+                    return FALSE;
+                }
+                u16 length = read_u16(at);
+                char value[LOG_BINARY_MAX_STRING + 1];
+                u16 copied = length < LOG_BINARY_MAX_STRING ? length : LOG_BINARY_MAX_STRING;
+                memcpy(value, at + 2, copied);
+                value[copied] = 0;
+                at += 2 + length;
+                PRINT_VALUE(value);
+            } break;
+        }
+#undef PRINT_VALUE
+    }
+    print_literal(cursor, text + format->length);
+    fputc('\n', stdout);
+    return TRUE;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: log_decoder <file.kblg> [--unsorted]\n");
+        return 1;
+    }
+    b8 sorted = !(argc > 2 && strcmp(argv[2], "--unsorted") == 0);
+
+    u64 size = 0;
+    u8* data = load_file(argv[1], &size);
+    if (!data) {
+        return 1;
+    }
+    log_binary_header header;
+    if (size < sizeof(header)) {
+        fprintf(stderr, "'%s' is too small to be a binary log.\n", argv[1]);
+        return 1;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != LOG_BINARY_MAGIC || header.version != LOG_BINARY_VERSION) {
+        fprintf(stderr, "'%s' is not a binary log (or has version %u, expected %u).\n",
+                argv[1], header.version, LOG_BINARY_VERSION);
+        return 1;
+    }
+
+    // Проход 1: форматы и список сообщений
+    decoded_format* formats = 0;
+    u32 format_capacity = 0;
+    decoded_message* messages = 0;
+    u64 message_count = 0;
+    u64 message_capacity = 0;
+    u64 offset = sizeof(header);
+    while (offset < size) {
+        u64 length = record_size(data, size, offset);
+        if (length == 0) {
+            fprintf(stderr, "Truncated or corrupt record at offset %llu; stopping.\n", (unsigned long long)offset);
+            break;
+        }
+        const u8* record = data + offset;
+        if (record[0] == LOG_BINARY_RECORD_FORMAT) {
+            u32 id = read_u32(record + 1);
+            if (id >= format_capacity) {
+                u32 capacity = format_capacity ? format_capacity : 64;
+                while (capacity <= id) {
+                    capacity *= 2;
+                }
+                formats = realloc(formats, capacity * sizeof(decoded_format));
+                memset(formats + format_capacity, 0, (capacity - format_capacity) * sizeof(decoded_format));
+                format_capacity = capacity;
+            }
+            decoded_format* format = &formats[id];
+            format->level = record[5];
+            format->length = read_u16(record + 6);
+            format->text = (const char*)record + 8;
+            format->arg_count = record[8 + format->length];
+            format->arg_types = record + 9 + format->length;
+        } else {
+            if (message_count == message_capacity) {
+                message_capacity = message_capacity ? message_capacity * 2 : 1024;
+                messages = realloc(messages, message_capacity * sizeof(decoded_message));
+            }
+            messages[message_count].timestamp_ns = read_u64(record + 7);
+            messages[message_count].offset = offset;
+            message_count++;
+        }
+        offset += length;
+    }
+
+    // Потоки пишут блоками, поэтому в файле сообщения идут не по времени
+    if (sorted) {
+        qsort(messages, message_count, sizeof(decoded_message), compare_messages);
+    }
+
+    // Проход 2: сообщения
+    u64 bad = 0;
+    for (u64 i = 0; i < message_count; ++i) {
+        const u8* record = data + messages[i].offset;
+        u32 id = read_u32(record + 1);
+        u16 thread = read_u16(record + 5);
+        u16 payload_size = read_u16(record + 15);
+        if (id >= format_capacity || !formats[id].text) {
+            printf("[?] %.6f t%u: <unknown format %u>\n", (f64)messages[i].timestamp_ns * 0.000000001, thread, id);
+            bad++;
+            continue;
+        }
+        if (!print_message(&formats[id], thread, messages[i].timestamp_ns,
+                           record + LOG_BINARY_MESSAGE_HEADER_SIZE, payload_size)) {
+            printf(" <payload does not match format %u>\n", id);
+            bad++;
+        }
+    }
+
+    fprintf(stderr, "%llu messages, %llu undecodable.\n", (unsigned long long)message_count, (unsigned long long)bad);
+    free(messages);
+    free(formats);
+    free(data);
+    return bad ? 2 : 0;
+}